@@ -1,7 +1,10 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
+from esphome.core import CORE
 from esphome.const import (
+    CONF_ADDRESS,
     CONF_ID,
+    CONF_NAME,
     CONF_UART_ID,
 )
 from esphome.components import (
@@ -13,14 +16,129 @@ OmnikBase = omnik_base.class_(
     "OmnikBase",
     cg.Component,
 )
+omnik_bus_ns = cg.esphome_ns.namespace("omnik_bus")
+OmnikBus = omnik_bus_ns.class_(
+    "OmnikBus",
+    OmnikBase,
+)
+
+CONF_FRAME_GAP = "frame_gap"
+CONF_HEAP_STATISTICS = "heap_statistics"
+CONF_NAME_PREFIX = "name_prefix"
+CONF_OMNIK_BUS_ID = "omnik_bus_id"
+CONF_PUBLISH_BATCH = "publish_batch"
+CONF_PUBLISH_BATCH_SIZE = "size"
+CONF_PUBLISH_TIME_BUDGET = "time_budget"
+CONF_RX_TASK = "rx_task"
+
+RX_TASK_SCHEMA = cv.Schema({
+    cv.Optional(CONF_RX_TASK, default=False): cv.boolean,
+})
+
+FRAME_GAP_SCHEMA = cv.Schema({
+    cv.Optional(CONF_FRAME_GAP): cv.positive_not_null_time_period,
+})
+
+PUBLISH_BATCH_SCHEMA = cv.Schema({
+    cv.Optional(CONF_PUBLISH_BATCH_SIZE, default=8):
+        cv.int_range(min=1, max=64),
+    cv.Optional(CONF_PUBLISH_TIME_BUDGET, default="2ms"):
+        cv.positive_time_period_microseconds,
+})
 
 CONFIG_SCHEMA_BASE = (
     cv.COMPONENT_SCHEMA
-    .extend(uart.UART_DEVICE_SCHEMA)
+    .extend(RX_TASK_SCHEMA)
+    .extend(FRAME_GAP_SCHEMA)
+    .extend({
+        cv.Optional(CONF_UART_ID): cv.use_id(uart.UARTComponent),
+        cv.Optional(CONF_OMNIK_BUS_ID): cv.use_id(OmnikBus),
+        cv.Optional(CONF_ADDRESS): cv.hex_uint16_t,
+        cv.Optional(CONF_NAME_PREFIX): cv.string_strict,
+        cv.Optional(CONF_HEAP_STATISTICS, default=False): cv.boolean,
+        cv.Optional(CONF_PUBLISH_BATCH, default={}): PUBLISH_BATCH_SCHEMA,
+    })
 )
 
+def validate_rx_task(config):
+    """
+    Validate the receive task configuration.
+
+    The receive task needs a UART and is only supported on the ESP32 and on a
+    host.
+    """
+    if not config[CONF_RX_TASK]:
+        return config
+    if CONF_UART_ID not in config:
+        raise cv.Invalid(f"{CONF_RX_TASK} requires {CONF_UART_ID}")
+    if not (CORE.is_esp32 or CORE.is_host):
+        raise cv.Invalid(f"{CONF_RX_TASK} is only supported on the ESP32")
+    return config
+
+def validate_frame_gap(config):
+    """
+    Validate the frame gap configuration.
+
+    The frame gap belongs to the component that owns the UART, so it is set on
+    the Omnik bus and not on the devices that are attached to it.
+    """
+    if CONF_FRAME_GAP in config and CONF_OMNIK_BUS_ID in config:
+        raise cv.Invalid(
+            f"{CONF_FRAME_GAP} is set on the Omnik bus, not with "
+            f"{CONF_OMNIK_BUS_ID}")
+    return config
+
+def validate_base(default_name_prefix):
+    """
+    Validate the base configuration.
+
+    The component either owns a UART or is attached to an Omnik bus. In case
+    a name prefix is given, then it replaces the default name prefix of all
+    the sensors, so that several devices can be configured at the same time.
+    """
+    def validator(config):
+        config = cv.has_exactly_one_key(CONF_UART_ID, CONF_OMNIK_BUS_ID)(config)
+        config = validate_rx_task(config)
+        config = validate_frame_gap(config)
+        if CONF_NAME_PREFIX not in config:
+            return config
+        name_prefix = config[CONF_NAME_PREFIX]
+        for value in config.values():
+            sensor_configs = value if isinstance(value, list) else [value]
+            for sensor_config in sensor_configs:
+                if not isinstance(sensor_config, dict):
+                    continue
+                name = sensor_config.get(CONF_NAME)
+                if name is not None and name.startswith(default_name_prefix):
+                    sensor_config[CONF_NAME] = (
+                        name_prefix + name[len(default_name_prefix):])
+        return config
+    return validator
+
 async def to_code_base(config):
     comp = cg.new_Pvariable(config[CONF_ID])
     await cg.register_component(comp, config)
-    await uart.register_uart_device(comp, config)
+    if CONF_UART_ID in config:
+        await uart.register_uart_device(comp, config)
+    if CONF_OMNIK_BUS_ID in config:
+        bus = await cg.get_variable(config[CONF_OMNIK_BUS_ID])
+        cg.add(bus.register_device(comp))
+    if CONF_ADDRESS in config:
+        cg.add(comp.set_address(config[CONF_ADDRESS]))
+    await to_code_frame_gap(comp, config)
+    if config[CONF_HEAP_STATISTICS]:
+        cg.add(comp.set_heap_statistics(True))
+    publish_batch = config[CONF_PUBLISH_BATCH]
+    cg.add(comp.set_publish_batch(
+        publish_batch[CONF_PUBLISH_BATCH_SIZE],
+        publish_batch[CONF_PUBLISH_TIME_BUDGET].total_microseconds))
+    await to_code_rx_task(comp, config)
     return comp
+
+async def to_code_rx_task(comp, config):
+    if config[CONF_RX_TASK]:
+        cg.add(comp.set_rx_task(True))
+
+async def to_code_frame_gap(comp, config):
+    if CONF_FRAME_GAP in config:
+        cg.add(comp.set_frame_gap(config[CONF_FRAME_GAP].total_microseconds))
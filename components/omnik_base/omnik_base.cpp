@@ -1,13 +1,40 @@
 #include "esphome/components/omnik_base/omnik_base.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#if defined(USE_ESP8266)
+#include <Esp.h>
+#elif defined(USE_ESP32)
+#include <esp_heap_caps.h>
+#endif
+
 namespace esphome {
 namespace omnik_base {
 
 // Tag that is used for log messages.
 static const char *const LOG_TAG = "omnik_base";
-// Timeout for receiving the bytes of the same message from the uart
-// (in milliseconds).
-static const uint32_t RECEIVE_TIMEOUT = 50;
+// The gap after which the received bytes of an incomplete message are
+// discarded (in half character times, so 3.5 character times), on top of the
+// time the UART driver holds the received bytes.
+static const uint32_t FRAME_GAP_HALF_BYTES = 7;
+// The minimum gap (in microseconds). Like Modbus RTU, a fixed gap is used above
+// 19200 baud, where 3.5 character times would be shorter than the jitter of
+// the loop.
+static const uint32_t MIN_FRAME_GAP = 1750;
+// The number of characters that the UART driver can hold before the received
+// bytes are available: while bytes keep arriving, the driver only moves them
+// from the RX FIFO when the FIFO reaches its full threshold (120 bytes with the
+// ESP-IDF defaults, 100 bytes with the ESP8266 Arduino core). The bytes of the
+// host UART are available right away.
+#if defined(USE_ESP32)
+static const uint32_t UART_HOLD_BYTES = 120;
+#elif defined(USE_ESP8266)
+static const uint32_t UART_HOLD_BYTES = 100;
+#else
+static const uint32_t UART_HOLD_BYTES = 0;
+#endif
 
 /**
  * Convert an EntityCategory to a string.
@@ -86,6 +113,39 @@ dump_config(const char *const tag, std::string prefix,
               entity_base_unit_of_measurement->get_unit_of_measurement());
 }
 
+/**
+ * Get the free heap (in bytes, 0 in case it isn't known on this platform).
+ */
+static uint32_t get_free_heap() {
+#if defined(USE_ESP8266)
+  return ESP.getFreeHeap();
+#elif defined(USE_ESP32)
+  return heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+#else
+  return 0;
+#endif
+}
+
+/**
+ * Get the fragmentation of the heap (in percent, 0 in case it isn't known on
+ * this platform).
+ */
+static uint8_t get_heap_fragmentation() {
+#if defined(USE_ESP8266)
+  return ESP.getHeapFragmentation();
+#elif defined(USE_ESP32)
+  size_t free_size = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+  size_t largest_free_block =
+      heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+  if (free_size == 0) {
+    return 0;
+  }
+  return 100 - largest_free_block * 100 / free_size;
+#else
+  return 0;
+#endif
+}
+
 /**
  * Trim spaces from both sides of the string.
  *
@@ -119,32 +179,106 @@ static std::string trim(std::string source) {
   return {new_begin, new_end};
 }
 
+/**
+ * @see the header file.
+ */
+void OmnikBase::setup() {
+  this->set_interval("warning_summary", WarningLimiter::SUMMARY_INTERVAL,
+                     [this]() {
+                       this->warning_limiter_.log_summary(LOG_TAG, millis());
+                     });
+
+  // A component that is attached to an Omnik bus doesn't own the UART.
+  if (this->parent_ == nullptr) {
+    return;
+  }
+
+  this->frame_gap_ = this->calculate_frame_gap();
+  this->frame_assembler_.set_timeout(this->frame_gap_);
+
+  if (this->use_rx_task_) {
+    if (!RxTask::is_supported()) {
+      ESP_LOGW(LOG_TAG, "A receive task isn't supported on this platform");
+    } else {
+      this->rx_queue_.reset(new RxQueue());
+      if (this->rx_task_.start("omnik_rx", receive_in_task, this)) {
+        return;
+      }
+      ESP_LOGE(LOG_TAG, "Failed to start the receive task");
+      this->rx_queue_.reset();
+    }
+  }
+
+  // The loop is disabled while nothing is received, so it has to be woken up
+  // before the UART buffer overflows.
+  this->wakeup_interval_ = this->calculate_wakeup_interval();
+  this->power_save_interval_ = this->calculate_power_save_interval();
+  this->set_interval("rx_wakeup", this->wakeup_interval_,
+                     [this]() { this->enable_loop(); });
+}
+
 /**
  * @see the header file.
  */
 void OmnikBase::loop() {
-  const uint32_t now = millis();
+  // Publish the next batch of the values of the previous messages. The loop
+  // isn't disabled until they are all published.
+  this->publish_scheduler_.flush();
+
+  // A component that is attached to an Omnik bus doesn't own the UART. It
+  // receives its messages from the bus.
+  if (this->parent_ == nullptr) {
+    if (!this->publish_scheduler_.has_pending()) {
+      this->disable_loop();
+    }
+    return;
+  }
+
+  // The bytes are received by the receive task. It enables the loop again
+  // once it has queued a message.
+  if (this->rx_queue_ != nullptr) {
+    this->process_rx_queue();
+    if (this->rx_queue_->is_empty() &&
+        !this->publish_scheduler_.has_pending()) {
+      this->disable_loop();
+    }
+    return;
+  }
+
+  const uint32_t now = micros();
 
-  // Discard all received data in case the next byte isn't received within a
-  // predefined timeout period.
-  if (this->last_received_time_ + RECEIVE_TIMEOUT < now) {
-    this->rx_buffer_.clear();
-    this->last_received_time_ = now;
+  // Discard the bytes of an incomplete message in case the next byte isn't
+  // received within the frame gap. A byte that is still in the UART buffer
+  // may have been received long ago, so only an empty buffer is a gap.
+  if (!this->available() && this->frame_assembler_.check_timeout(now)) {
+    this->link_statistics_.nr_of_timeouts++;
   }
 
-  // Process the next byte that is received. One byte at a time ensures a
-  // minimal blocking time.
-  if (this->available()) {
+  // Process the bytes that are received, until a message is complete. One
+  // message at a time ensures a minimal blocking time.
+  while (this->available()) {
     uint8_t byte;
 
-    this->last_received_time_ = now;
     this->read_byte(&byte);
-    rx_buffer_.push_back(byte);
+    this->link_statistics_.nr_of_bytes++;
+
+    FrameStatus status = this->frame_assembler_.add_byte(byte, now);
+    if (status == FRAME_OK || status == FRAME_CHECKSUM_ERROR) {
+      this->process_received_message(this->frame_assembler_.get_data(),
+                                     this->frame_assembler_.get_size());
+      break;
+    }
+  }
 
-    if (is_buffer_processed(rx_buffer_)) {
-      // In case this buffer has correctly been processed, then we can clear
-      // the buffer so that we can start processing the next message.
-      this->rx_buffer_.clear();
+  // Loop at a high frequency while a message is being received, so that the
+  // timeout is detected in time. Sleep until the next wakeup in case nothing
+  // is received.
+  if (this->frame_assembler_.is_receiving()) {
+    this->high_frequency_loop_requester_.start();
+  } else {
+    this->high_frequency_loop_requester_.stop();
+    if (!this->available() && !this->publish_scheduler_.has_pending()) {
+      this->disable_loop();
     }
   }
 }
@@ -152,71 +286,297 @@ void OmnikBase::loop() {
 /**
  * @see the header file.
  */
-bool OmnikBase::is_omnik_message_processed(std::vector<uint8_t> const &buffer) {
-  // Check the start bytes.
-  if (buffer.size() < 2)
-    return false;
-  if (buffer[0] != 0x3A || buffer[1] != 0x3A)
-    return true;
+void OmnikBase::start_power_save() {
+  if (this->wakeup_interval_ == 0 || this->is_power_saving_ ||
+      this->power_save_interval_ <= this->wakeup_interval_) {
+    return;
+  }
+  ESP_LOGD(LOG_TAG, "Power save: wakeup every %u ms",
+           (unsigned) this->power_save_interval_);
+  this->is_power_saving_ = true;
+  this->set_interval("rx_wakeup", this->power_save_interval_,
+                     [this]() { this->enable_loop(); });
+}
 
-  // Check the header bytes.
-  if (buffer.size() < 11)
-    return false;
-  uint8_t control_code = buffer[6];
-  uint8_t function_code = buffer[7];
-  uint8_t data_size = buffer[8];
+/**
+ * @see the header file.
+ */
+void OmnikBase::stop_power_save() {
+  if (!this->is_power_saving_) {
+    return;
+  }
+  ESP_LOGD(LOG_TAG, "Power save: stopped");
+  this->is_power_saving_ = false;
+  this->set_interval("rx_wakeup", this->wakeup_interval_,
+                     [this]() { this->enable_loop(); });
+}
+
+/**
+ * @see the header file.
+ */
+uint32_t OmnikBase::get_byte_time() {
+  uart::UARTComponent *uart = this->parent_;
+  uint32_t bits_per_byte = 1 + uart->get_data_bits() + uart->get_stop_bits();
+  if (uart->get_parity() != uart::UART_CONFIG_PARITY_NONE) {
+    bits_per_byte++;
+  }
+  uint32_t baud_rate = std::max<uint32_t>(uart->get_baud_rate(), 1);
+  return std::max<uint32_t>(bits_per_byte * 1000000 / baud_rate, 1);
+}
 
-  // Get the expected check sum.
-  if (buffer.size() < (9 + data_size + 2))
+/**
+ * @see the header file.
+ */
+uint64_t OmnikBase::get_buffer_time() {
+  return (uint64_t) this->parent_->get_rx_buffer_size() * this->get_byte_time();
+}
+
+/**
+ * @see the header file.
+ */
+uint32_t OmnikBase::calculate_wakeup_interval() {
+  return std::max<uint32_t>(this->get_buffer_time() / 2000, 1);
+}
+
+/**
+ * @see the header file.
+ */
+uint32_t OmnikBase::calculate_power_save_interval() {
+  return std::max<uint32_t>(this->get_buffer_time() * 3 / 4000, 1);
+}
+
+/**
+ * @see the header file.
+ */
+uint32_t OmnikBase::calculate_frame_gap() {
+  if (this->frame_gap_ > 0) {
+    return this->frame_gap_;
+  }
+  // Within a message the bytes can arrive in bursts of the full threshold of
+  // the RX FIFO, which must not be taken as the end of the message.
+  uint32_t half_bytes = 2 * UART_HOLD_BYTES + FRAME_GAP_HALF_BYTES;
+  return std::max(this->get_byte_time() * half_bytes / 2, MIN_FRAME_GAP);
+}
+
+/**
+ * @see the header file.
+ */
+bool OmnikBase::receive_in_task(void *argument) {
+  OmnikBase *omnik_base = static_cast<OmnikBase *>(argument);
+  FrameAssembler &frame_assembler = omnik_base->frame_assembler_;
+  const uint32_t now = micros();
+
+  // Only an empty UART buffer is a gap (see loop()).
+  int nr_of_bytes = omnik_base->available();
+  if (nr_of_bytes <= 0) {
+    if (frame_assembler.check_timeout(now)) {
+      omnik_base->rx_task_nr_of_timeouts_++;
+    }
     return false;
-  uint16_t expected_checksum =
-      (buffer[9 + data_size] << 8) + buffer[9 + data_size + 1];
+  }
 
-  // Check the checksum.
-  uint16_t actual_checksum = 0;
-  for (std::size_t index = 0; index < (9 + data_size); index++)
-    actual_checksum += buffer[index];
-  if (actual_checksum != expected_checksum) {
-    ESP_LOGW(LOG_TAG, "Checksum mismatch: actual=0x%04X expected=0x%04X",
-             actual_checksum, expected_checksum);
-    ESP_LOGI(LOG_TAG, "Received bytes: %s", to_hex(buffer, ':'));
-    return true;
+  uint8_t bytes[64];
+  nr_of_bytes = std::min<int>(nr_of_bytes, sizeof(bytes));
+  omnik_base->read_array(bytes, nr_of_bytes);
+  omnik_base->rx_task_nr_of_bytes_ += nr_of_bytes;
+
+  for (int index = 0; index < nr_of_bytes; index++) {
+    FrameStatus status = frame_assembler.add_byte(bytes[index], now);
+    if (status != FRAME_OK && status != FRAME_CHECKSUM_ERROR) {
+      continue;
+    }
+    ReceivedMessage *message = omnik_base->rx_queue_->get_free();
+    if (message == nullptr) {
+      omnik_base->rx_task_nr_of_dropped_messages_++;
+      continue;
+    }
+    message->size = frame_assembler.get_size();
+    memcpy(message->bytes, frame_assembler.get_data(), message->size);
+    omnik_base->rx_queue_->push();
+    omnik_base->enable_loop_soon_any_context();
   }
+  return true;
+}
 
-  ByteBuffer byte_buffer = ByteBuffer::wrap(
-      {buffer.begin() + 9, buffer.begin() + 9 + data_size}, BIG);
-  process_omnik_message(control_code, function_code, byte_buffer);
+/**
+ * @see the header file.
+ */
+void OmnikBase::process_rx_queue() {
+  this->link_statistics_.nr_of_bytes = this->rx_task_nr_of_bytes_;
+  this->link_statistics_.nr_of_timeouts = this->rx_task_nr_of_timeouts_;
+  this->link_statistics_.nr_of_dropped_messages =
+      this->rx_task_nr_of_dropped_messages_;
+
+  ReceivedMessage *message;
+  while ((message = this->rx_queue_->get_front()) != nullptr) {
+    this->process_received_message(message->bytes, message->size);
+    this->rx_queue_->pop();
+  }
+}
+
+/**
+ * @see the header file.
+ */
+void OmnikBase::process_received_message(const uint8_t buffer[],
+                                         size_t size) {
+  Frame frame;
+  switch (parse_frame(buffer, size, frame)) {
+  case FRAME_INCOMPLETE:
+  case FRAME_INVALID:
+    return;
+
+  case FRAME_CHECKSUM_ERROR:
+    this->link_statistics_.nr_of_checksum_errors++;
+    if (this->warning_limiter_.allow(WARNING_CHECKSUM_ERROR)) {
+      ESP_LOGW(LOG_TAG, "Checksum mismatch: actual=0x%04X expected=0x%04X",
+               frame.actual_checksum, frame.expected_checksum);
+      ESP_LOGI(LOG_TAG, "Received bytes: %s",
+               to_hex(buffer, size, ':').c_str());
+    }
+    return;
 
+  case FRAME_OK:
+    break;
+  }
+
+  this->link_statistics_.nr_of_messages++;
+  // The data is decoded straight from the bytes of the frame, so that a
+  // message isn't copied.
+  BigEndianReader reader(frame.data, frame.data_size);
+  route_omnik_message(frame.sender_address, frame.control_code,
+                      frame.function_code, reader);
+}
+
+/**
+ * @see the header file.
+ */
+bool OmnikBase::route_omnik_message(uint16_t sender_address,
+                                    uint8_t control_code,
+                                    uint8_t function_code,
+                                    BigEndianReader &buffer) {
+  if (!is_omnik_message_accepted(sender_address, control_code, function_code,
+                                 buffer)) {
+    return false;
+  }
+  buffer.set_position(0);
+  if (this->use_heap_statistics_) {
+    process_omnik_message_with_heap_statistics(control_code, function_code,
+                                               buffer);
+  } else {
+    process_omnik_message(control_code, function_code, buffer);
+  }
   return true;
 }
 
 /**
  * @see the header file.
  */
-bool OmnikBase::is_modbus_message_processed(
-    std::vector<uint8_t> const &buffer) {
-  return false;
+void OmnikBase::process_omnik_message_with_heap_statistics(
+    uint8_t control_code, uint8_t function_code, BigEndianReader &buffer) {
+  uint32_t free_before = get_free_heap();
+  process_omnik_message(control_code, function_code, buffer);
+  uint32_t free_after = get_free_heap();
+  uint8_t fragmentation = get_heap_fragmentation();
+
+  HeapStatistics &statistics = this->heap_statistics_;
+  if (statistics.nr_of_messages == 0 || free_after < statistics.min_free) {
+    statistics.min_free = free_after;
+  }
+  statistics.max_fragmentation =
+      std::max(statistics.max_fragmentation, fragmentation);
+  if (free_after < free_before) {
+    statistics.nr_of_growing_messages++;
+    statistics.max_growth =
+        std::max(statistics.max_growth, free_before - free_after);
+  }
+  statistics.nr_of_messages++;
 }
 
 /**
  * @see the header file.
  */
-bool OmnikBase::is_buffer_processed(std::vector<uint8_t> const &buffer) {
-  return is_omnik_message_processed(buffer) ||
-         is_modbus_message_processed(buffer);
+bool OmnikBase::is_omnik_message_accepted(uint16_t sender_address,
+                                          uint8_t control_code,
+                                          uint8_t function_code,
+                                          BigEndianReader &buffer) {
+  return !this->address_.has_value() || *this->address_ == sender_address;
+}
+
+/**
+ * @see the header file.
+ */
+void OmnikBase::process_unknown_omnik_message(const char *const tag,
+                                              uint8_t control_code,
+                                              uint8_t function_code,
+                                              BigEndianReader &buffer) {
+  this->link_statistics_.nr_of_unknown_messages++;
+  if (!this->unknown_messages_.record(control_code, function_code, buffer)) {
+    this->warning_limiter_.suppress(WARNING_UNKNOWN_MESSAGE);
+  } else if (this->warning_limiter_.allow(WARNING_UNKNOWN_MESSAGE)) {
+    ESP_LOGW(tag,
+             "Unknown combination: control_code=0x%02x, function_code=0x%02x",
+             control_code, function_code);
+  }
 }
 
 /**
  * @see the header file.
  */
 void dump_config(const char *const tag, std::string prefix,
-                 OmnikBase *omnikBase) {}
+                 OmnikBase *omnikBase) {
+  if (omnikBase == nullptr) {
+    return;
+  }
+  optional<uint16_t> address = omnikBase->get_address();
+  if (address.has_value()) {
+    ESP_LOGCONFIG(tag, "%sAddress: 0x%04X", prefix.c_str(), *address);
+  }
+  if (omnikBase->is_rx_task_running()) {
+    ESP_LOGCONFIG(tag, "%sRX Task: YES", prefix.c_str());
+  }
+  if (omnikBase->get_frame_gap() > 0) {
+    ESP_LOGCONFIG(tag, "%sFrame Gap: %u us", prefix.c_str(),
+                  (unsigned) omnikBase->get_frame_gap());
+  }
+  if (omnikBase->get_wakeup_interval() > 0) {
+    ESP_LOGCONFIG(tag, "%sWakeup Interval: %u ms", prefix.c_str(),
+                  (unsigned) omnikBase->get_wakeup_interval());
+    ESP_LOGCONFIG(tag, "%sPower Save Wakeup Interval: %u ms", prefix.c_str(),
+                  (unsigned) omnikBase->get_power_save_interval());
+  }
+  const PublishScheduler &scheduler = omnikBase->get_publish_scheduler();
+  ESP_LOGCONFIG(tag, "%sPublish Batch: %u values, %u us", prefix.c_str(),
+                scheduler.get_batch_size(),
+                (unsigned) scheduler.get_time_budget());
+  ESP_LOGCONFIG(tag, "%s  Published: %u in %u flushes (%u overwritten)",
+                prefix.c_str(), (unsigned) scheduler.get_nr_of_published(),
+                (unsigned) scheduler.get_nr_of_flushes(),
+                (unsigned) scheduler.get_nr_of_overwritten());
+  if (omnikBase->has_heap_statistics()) {
+    const HeapStatistics &statistics = omnikBase->get_heap_statistics();
+    ESP_LOGCONFIG(tag, "%sHeap Statistics:", prefix.c_str());
+    ESP_LOGCONFIG(tag, "%s  Messages: %u", prefix.c_str(),
+                  (unsigned) statistics.nr_of_messages);
+    ESP_LOGCONFIG(tag, "%s  Min Free: %u bytes", prefix.c_str(),
+                  (unsigned) statistics.min_free);
+    ESP_LOGCONFIG(tag, "%s  Max Fragmentation: %u%%", prefix.c_str(),
+                  (unsigned) statistics.max_fragmentation);
+    ESP_LOGCONFIG(tag, "%s  Growing Messages: %u (max %u bytes)",
+                  prefix.c_str(), (unsigned) statistics.nr_of_growing_messages,
+                  (unsigned) statistics.max_growth);
+  }
+  omnikBase->dump_unknown_messages(tag);
+}
 
 /**
  * @see the header file.
  */
 void dump_config(const char *const tag, std::string prefix,
                  sensor::Sensor *sensor) {
+  if (sensor == nullptr) {
+    ESP_LOGCONFIG(tag, "%sNot Used", prefix.c_str());
+    return;
+  }
   dump_config(tag, prefix, (EntityBase *)sensor);
   dump_config(tag, prefix, (EntityBase_DeviceClass *)sensor);
   dump_config(tag, prefix, (EntityBase_UnitOfMeasurement *)sensor);
@@ -243,27 +603,19 @@ void dump_config(const char *const tag, std::string prefix,
   dump_config(tag, prefix, "Unique ID", text_sensor->unique_id());
 }
 
-/**
- * @see the header file.
- */
-std::string to_hex(uint8_t byte) {
-  char buffer[5];
-
-  sprintf(buffer, "%02X", byte);
-  return buffer;
-}
-
 /**
  * @see the header file.
  */
 std::string to_hex(const uint8_t buffer[], size_t length, char separator) {
   std::string hex_representation;
+  char text[HEX_BYTE_SIZE];
 
   for (size_t i = 0; i < length; i++) {
     if (i > 0) {
       hex_representation += separator;
     }
-    hex_representation += to_hex(buffer[i]);
+    to_hex(buffer[i], text);
+    hex_representation += text;
   }
   return hex_representation;
 }
@@ -287,5 +639,17 @@ std::string to_string(std::vector<uint8_t> const &buffer) {
   return trim(result);
 }
 
+/**
+ * @see the header file.
+ */
+void publish_changed_state(text_sensor::TextSensor *text_sensor,
+                           const char *state) {
+  if (text_sensor == nullptr ||
+      (text_sensor->has_state() && text_sensor->state == state)) {
+    return;
+  }
+  text_sensor->publish_state(state);
+}
+
 } // namespace omnik_base
 } // namespace esphome
@@ -3,7 +3,18 @@
 #include "esphome/components/sensor/sensor.h"
 #include "esphome/components/text_sensor/text_sensor.h"
 #include "esphome/components/uart/uart.h"
-#include "esphome/core/bytebuffer.h"
+#include "esphome/core/helpers.h"
+#include "omnik_discovery.h"
+#include "omnik_frame.h"
+#include "omnik_frame_assembler.h"
+#include "omnik_publish_scheduler.h"
+#include "omnik_rx_task.h"
+#include "omnik_spsc_queue.h"
+#include "omnik_text.h"
+#include "omnik_warning_limiter.h"
+
+#include <atomic>
+#include <memory>
 
 #define OMNIK_MESSAGE_ID(control_code, function_code)                          \
   ((control_code << 8) + function_code)
@@ -11,19 +22,228 @@
 namespace esphome {
 namespace omnik_base {
 
+/**
+ * The statistics of the received bytes and messages.
+ */
+struct LinkStatistics {
+  // The number of bytes that have been received.
+  uint32_t nr_of_bytes;
+  // The number of messages with a correct checksum.
+  uint32_t nr_of_messages;
+  // The number of messages with a checksum mismatch.
+  uint32_t nr_of_checksum_errors;
+  // The number of times the received bytes were discarded, because the next
+  // byte wasn't received in time.
+  uint32_t nr_of_timeouts;
+  // The number of messages that aren't known.
+  uint32_t nr_of_unknown_messages;
+  // The number of messages that were dropped, because the queue of the
+  // receive task was full.
+  uint32_t nr_of_dropped_messages;
+};
+
+/**
+ * The statistics of the heap around the processing of the messages.
+ */
+struct HeapStatistics {
+  // The number of processed messages.
+  uint32_t nr_of_messages;
+  // The lowest free heap after processing a message (in bytes).
+  uint32_t min_free;
+  // The highest fragmentation after processing a message (in percent).
+  uint8_t max_fragmentation;
+  // The number of messages after which less heap was free than before.
+  uint32_t nr_of_growing_messages;
+  // The largest decrease of the free heap by processing one message (in
+  // bytes).
+  uint32_t max_growth;
+};
+
 /**
  * The base class for the Omnik components. This class is responsible for
  * reciving the bytes from the UART and checking the checksum. the processing of
  * the specific messages is then delegated to the child class(es).
  */
 class OmnikBase : public uart::UARTDevice, public Component {
+public:
+  /**
+   * Start the receive task or the wakeup of the loop, and the summary of the
+   * protocol warnings.
+   */
+  void setup() override;
 
   /**
    * Check and do what has to be done.
    */
   void loop() override;
 
+  /**
+   * Receive the bytes from the UART in a separate task.
+   *
+   * The task assembles the received bytes into messages and passes them to
+   * loop() through a queue. Then a busy main loop can't cause the UART buffer
+   * to overflow.
+   *
+   * @param rx_task True in case a separate task is used.
+   */
+  void set_rx_task(bool rx_task) { this->use_rx_task_ = rx_task; }
+
+  /**
+   * Check whether the bytes are received in a separate task.
+   */
+  bool is_rx_task_running() const { return this->rx_task_.is_running(); }
+
+  /**
+   * Set the gap after which the received bytes of an incomplete message are
+   * discarded (in microseconds). It must be longer than the time the UART
+   * driver holds the received bytes before they are available. By default it
+   * is that time (the full threshold of the RX FIFO of the platform) plus 3.5
+   * character times at the baud rate of the UART, but at least 1750 us.
+   */
+  void set_frame_gap(uint32_t frame_gap) { this->frame_gap_ = frame_gap; }
+
+  /**
+   * Get the gap after which the received bytes of an incomplete message are
+   * discarded (in microseconds, 0 in case the component doesn't own a UART).
+   */
+  uint32_t get_frame_gap() const { return this->frame_gap_; }
+
+  /**
+   * Get the interval (in milliseconds) at which the idle loop is woken up to
+   * check for received bytes (0 in case the loop isn't idle).
+   */
+  uint32_t get_wakeup_interval() const { return this->wakeup_interval_; }
+
+  /**
+   * Get the slow interval (in milliseconds) at which the idle loop is woken
+   * up while saving power (0 in case the loop isn't idle).
+   */
+  uint32_t get_power_save_interval() const {
+    return this->power_save_interval_;
+  }
+
+  /**
+   * Check whether the idle loop is woken up at the slow power save interval.
+   */
+  bool is_power_saving() const { return this->is_power_saving_; }
+
+  /**
+   * Only accept the messages that are sent from this address.
+   *
+   * @param address The sender address of the device.
+   */
+  void set_address(uint16_t address) { this->address_ = address; }
+
+  /**
+   * Get the sender address from which the messages are accepted.
+   */
+  optional<uint16_t> get_address() const { return this->address_; }
+
+  /**
+   * Get the statistics of the received bytes and messages.
+   */
+  const LinkStatistics &get_link_statistics() const {
+    return this->link_statistics_;
+  }
+
+  /**
+   * Keep statistics of the heap around the processing of the messages.
+   *
+   * @param heap_statistics True in case the statistics are kept.
+   */
+  void set_heap_statistics(bool heap_statistics) {
+    this->use_heap_statistics_ = heap_statistics;
+  }
+
+  /**
+   * Check whether the statistics of the heap are kept.
+   */
+  bool has_heap_statistics() const { return this->use_heap_statistics_; }
+
+  /**
+   * Get the statistics of the heap around the processing of the messages.
+   */
+  const HeapStatistics &get_heap_statistics() const {
+    return this->heap_statistics_;
+  }
+
+  /**
+   * Spread the publishing of the decoded values over several loop
+   * iterations.
+   *
+   * @param batch_size The maximum number of values that are published in one
+   *                   loop iteration.
+   * @param time_budget The time after which no more values are published in
+   *                    one loop iteration (in microseconds).
+   */
+  void set_publish_batch(uint8_t batch_size, uint32_t time_budget) {
+    this->publish_scheduler_.set_batch_size(batch_size);
+    this->publish_scheduler_.set_time_budget(time_budget);
+  }
+
+  /**
+   * Get the scheduler of the publishing of the decoded values.
+   */
+  const PublishScheduler &get_publish_scheduler() const {
+    return this->publish_scheduler_;
+  }
+
+  /**
+   * Log the unknown messages that have been received.
+   *
+   * @param tag The tag to use for the log messages.
+   */
+  void dump_unknown_messages(const char *const tag) const {
+    this->unknown_messages_.dump(tag);
+  }
+
+  /**
+   * Route a received Omnik message to this component.
+   *
+   * The message is processed in case it is accepted by this component.
+   *
+   * @param sender_address The address of the sender of the message.
+   * @param control_code The control code.
+   * @param function_code The function code.
+   * @param buffer The data of the message.
+   * @return True in case the message was accepted, False otherwise.
+   */
+  virtual bool route_omnik_message(uint16_t sender_address,
+                                   uint8_t control_code, uint8_t function_code,
+                                   BigEndianReader &buffer);
+
 protected:
+  // The sender address from which the messages are accepted (all addresses in
+  // case it isn't set).
+  optional<uint16_t> address_{};
+  // The unknown messages that have been received.
+  UnknownMessages unknown_messages_;
+  // The statistics of the received bytes and messages.
+  LinkStatistics link_statistics_{};
+  // Limits the protocol warnings that are logged.
+  WarningLimiter warning_limiter_;
+  // True in case the statistics of the heap are kept.
+  bool use_heap_statistics_{false};
+  // The statistics of the heap around the processing of the messages.
+  HeapStatistics heap_statistics_{};
+  // The decoded values that are published in the next loop iterations. The
+  // child class stages its values and then calls enable_loop().
+  PublishScheduler publish_scheduler_;
+
+  /**
+   * Check whether a message should be processed by this component.
+   *
+   * @param sender_address The address of the sender of the message.
+   * @param control_code The control code.
+   * @param function_code The function code.
+   * @param buffer The data of the message.
+   * @return True in case the message is accepted, False otherwise.
+   */
+  virtual bool is_omnik_message_accepted(uint16_t sender_address,
+                                         uint8_t control_code,
+                                         uint8_t function_code,
+                                         BigEndianReader &buffer);
+
   /**
    * process an Omnik message.
    *
@@ -32,58 +252,158 @@ protected:
    * @param buffer The data of the message.
    */
   virtual void process_omnik_message(uint8_t control_code,
-                                     uint8_t function_code, ByteBuffer &buffer);
+                                     uint8_t function_code,
+                                     BigEndianReader &buffer) = 0;
+
+  /**
+   * Process an unknown Omnik message.
+   *
+   * The message is recorded, and a warning is logged the first time it is
+   * received (unless the warnings are suppressed by the warning limiter).
+   *
+   * @param tag The tag to use for the log messages.
+   * @param control_code The control code.
+   * @param function_code The function code.
+   * @param buffer The data of the message.
+   */
+  void process_unknown_omnik_message(const char *const tag,
+                                     uint8_t control_code,
+                                     uint8_t function_code,
+                                     BigEndianReader &buffer);
+
+  /**
+   * Wake up the idle loop at a slow interval, e.g. while the inverter is
+   * asleep for the night. The slow interval is still shorter than the time to
+   * fill the UART buffer, so the received bytes aren't lost and the power
+   * save lasts until stop_power_save() is called. Only a change of the state
+   * is logged.
+   *
+   * This only applies to a component that owns the UART and that doesn't
+   * receive the bytes in a separate task.
+   */
+  void start_power_save();
+
+  /**
+   * Wake up the idle loop at the normal interval again.
+   */
+  void stop_power_save();
 
 private:
-  // The time (in milliseconds) at which the last byte has been received.
-  uint32_t last_received_time_{0};
-  // The buffer with the bytes that already have been reiceived.
-  std::vector<uint8_t> rx_buffer_;
+  /**
+   * A message that has been received by the receive task.
+   */
+  struct ReceivedMessage {
+    // The number of bytes of the message.
+    size_t size;
+    // The bytes of the message.
+    uint8_t bytes[MAX_FRAME_SIZE];
+  };
+
+  // The number of entries of the queue of the receive task.
+  static const size_t RX_QUEUE_SIZE = 8;
+
+  // The queue of the messages that have been received by the receive task.
+  using RxQueue = SpscQueue<ReceivedMessage, RX_QUEUE_SIZE>;
+
+  // Assembles the received bytes into messages.
+  FrameAssembler frame_assembler_;
+  // Requests a high frequency loop while a message is being received.
+  HighFrequencyLoopRequester high_frequency_loop_requester_;
+  // The gap after which the received bytes of an incomplete message are
+  // discarded (in microseconds).
+  uint32_t frame_gap_{0};
+  // The interval (in milliseconds) at which the idle loop is woken up.
+  uint32_t wakeup_interval_{0};
+  // The interval (in milliseconds) at which the idle loop is woken up while
+  // saving power.
+  uint32_t power_save_interval_{0};
+  // True in case the idle loop is woken up at the slow power save interval.
+  bool is_power_saving_{false};
+  // True in case the bytes are received in a separate task.
+  bool use_rx_task_{false};
+  // The receive task.
+  RxTask rx_task_;
+  // The messages from the receive task (only in case the task is running).
+  std::unique_ptr<RxQueue> rx_queue_;
+  // The statistics of the receive task.
+  std::atomic<uint32_t> rx_task_nr_of_bytes_{0};
+  std::atomic<uint32_t> rx_task_nr_of_timeouts_{0};
+  std::atomic<uint32_t> rx_task_nr_of_dropped_messages_{0};
+
+  /**
+   * Get the time it takes to receive one byte at the baud rate of the UART (in
+   * microseconds).
+   */
+  uint32_t get_byte_time();
+
+  /**
+   * Calculate the gap after which the received bytes of an incomplete
+   * message are discarded, unless it has been configured.
+   *
+   * @return The gap (in microseconds).
+   */
+  uint32_t calculate_frame_gap();
 
   /**
-   * Process the Omnik message in the buffer.
+   * Get the time to fill the UART buffer.
    *
-   * Try to process the Omnik message in the buffer. The logic is the same as in
-   * the function is_buffer_processed() except then for Omnik messages.  An
-   * Omnik message has the following format:
-   * * buffer[0 .. 1] Start bytes (value 0x3A).
-   * * buffer[2 .. 3] Sender address.
-   * * buffer[4 .. 5] Receiver address.
-   * * buffer[6] Control code.
-   * * buffer[7] Function code.
-   * * buffer[8] Data size.
-   * * buffer[9 .. 9 + Data size - 1] Data.
-   * * buffer[9 + Data size .. 9 + Data size + 1] Check sum.
+   * @return The time (in microseconds).
+   */
+  uint64_t get_buffer_time();
+
+  /**
+   * Calculate the interval at which the idle loop must be woken up, so that
+   * the UART buffer is at most half full when the bytes are read.
    *
-   * @param buffer The buffer with the bytes of the message.
-   * @return True in case the buffer (message) was processed, False otherwise.
+   * @return The interval (in milliseconds).
    */
-  bool is_omnik_message_processed(std::vector<uint8_t> const &buffer);
+  uint32_t calculate_wakeup_interval();
 
   /**
-   * Process the Modbus message in the buffer.
+   * Calculate the interval at which the idle loop is woken up while saving
+   * power, so that the UART buffer is at most three quarters full when the
+   * bytes are read. The last quarter is the margin for the latency of the
+   * loop.
    *
-   * Try to process the Modbus message in the buffer. The logic is the same as
-   * in the function is_buffer_processed() except then for Modbus messages.
+   * @return The interval (in milliseconds).
+   */
+  uint32_t calculate_power_save_interval();
+
+  /**
+   * Receive the available bytes from the UART and queue the complete
+   * messages. This runs in the receive task.
    *
-   * @param buffer The buffer with the bytes of the message.
-   * @return True in case the buffer (message) was processed, False otherwise.
+   * @param argument The OmnikBase.
+   * @return False in case no bytes were available.
+   */
+  static bool receive_in_task(void *argument);
+
+  /**
+   * Process the messages that have been queued by the receive task.
    */
-  bool is_modbus_message_processed(std::vector<uint8_t> const &buffer);
+  void process_rx_queue();
 
   /**
-   * Process the message in the buffer.
+   * Process a complete message that has been received.
    *
-   * Try to process the message in the buffer. The buffer can contain garbage, a
-   * partly recognized messages or a complete message. In case the buffer
-   * contains a complete recognized message, then it is processed and this
-   * function will return True. Otherwise, in case the message can't be
-   * processed, then it will return False.
+   * The checksum is checked and a correct message is routed to the child
+   * class(es). See Frame for the format of an Omnik message.
    *
-   * @param buffer The buffer with the bytes of the message.
-   * @return True in case the buffer (message) was processed, False otherwise.
+   * @param buffer The bytes of the message.
+   * @param size The number of bytes.
+   */
+  void process_received_message(const uint8_t buffer[], size_t size);
+
+  /**
+   * Process an accepted message and update the statistics of the heap.
+   *
+   * @param control_code The control code.
+   * @param function_code The function code.
+   * @param buffer The data of the message.
    */
-  bool is_buffer_processed(std::vector<uint8_t> const &buffer);
+  void process_omnik_message_with_heap_statistics(uint8_t control_code,
+                                                  uint8_t function_code,
+                                                  BigEndianReader &buffer);
 };
 
 /**
@@ -104,14 +424,6 @@ void dump_config(const char *const tag, std::string prefix,
 void dump_config(const char *const tag, std::string prefix,
                  text_sensor::TextSensor *text_sensor);
 
-/**
- * Convert a byte to a hexadecimal representation.
- *
- * @param byte The byte value.
- * @return A string with a hexadecimal representation of the byte.
- */
-std::string to_hex(uint8_t byte);
-
 /**
  * Convert the byte buffer to a hexadecimal representation.
  *
@@ -136,5 +448,36 @@ std::string to_hex(std::vector<uint8_t> const &buffer, char separator);
  */
 std::string to_string(std::vector<uint8_t> const &buffer);
 
+/**
+ * Publish the state of a text sensor, but only in case it has changed. Then a
+ * state that doesn't change doesn't allocate memory.
+ *
+ * @param text_sensor The text sensor.
+ * @param state The state.
+ */
+void publish_changed_state(text_sensor::TextSensor *text_sensor,
+                           const char *state);
+
+/**
+ * The text state of a text sensor for the message handlers that are shared
+ * with the host tools (see process_status_message()).
+ */
+class ChangedTextState {
+public:
+  explicit ChangedTextState(text_sensor::TextSensor *text_sensor)
+      : text_sensor_(text_sensor) {}
+
+  /**
+   * Publish the state, but only in case it has changed.
+   */
+  void publish(const char *state) {
+    publish_changed_state(this->text_sensor_, state);
+  }
+
+private:
+  // The text sensor (nullptr in case it isn't used).
+  text_sensor::TextSensor *text_sensor_;
+};
+
 } // namespace omnik_base
 } // namespace esphome
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "omnik_base.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace esphome {
+namespace omnik_base {
+
+// The data size of a message handler that accepts any data size.
+static const uint16_t ANY_DATA_SIZE = 0xFFFF;
+
+/**
+ * The base class for the Omnik components that process the messages with a
+ * table of message handlers.
+ *
+ * The child class declares a constexpr table MESSAGE_HANDLERS of message
+ * handlers, sorted by message id, and a LOG_TAG. A message is processed by the
+ * first handler with the same message id and data size. A message that has no
+ * handler (an unknown message or a known message with an unknown data size) is
+ * processed as an unknown message. Because the table is known at compile time
+ * the order is checked when the component is compiled, and the handlers of a
+ * message id are found with a binary search and called without virtual calls.
+ *
+ * OmnikBase (and omnik_bus, which routes the messages to devices of different
+ * types) reaches the device through the virtual process_omnik_message(), so
+ * that is the one virtual call per message.
+ *
+ * @tparam Device The child class.
+ */
+template <typename Device> class OmnikDevice : public OmnikBase {
+protected:
+  /**
+   * A handler of a message.
+   */
+  struct MessageHandler {
+    // The message id (see OMNIK_MESSAGE_ID).
+    uint16_t message_id;
+    // The data size of the message (ANY_DATA_SIZE in case any size is
+    // accepted).
+    uint16_t data_size;
+    // The function that processes the data of the message.
+    void (Device::*handler)(BigEndianReader &buffer);
+  };
+
+  /**
+   * process an Omnik message with the table of message handlers.
+   *
+   * See omnik_base::OmnikBase for a full description.
+   */
+  void process_omnik_message(uint8_t control_code, uint8_t function_code,
+                             BigEndianReader &buffer) final {
+    static_assert(is_sorted_by_message_id(),
+                  "MESSAGE_HANDLERS must be sorted by message id");
+    const uint16_t message_id = OMNIK_MESSAGE_ID(control_code, function_code);
+    const size_t data_size = buffer.get_limit();
+    const MessageHandler *end = std::end(Device::MESSAGE_HANDLERS);
+    const MessageHandler *entry = std::lower_bound(
+        std::begin(Device::MESSAGE_HANDLERS), end, message_id,
+        [](const MessageHandler &handler, uint16_t id) {
+          return handler.message_id < id;
+        });
+    for (; entry != end && entry->message_id == message_id; entry++) {
+      if (entry->data_size == ANY_DATA_SIZE || entry->data_size == data_size) {
+        (static_cast<Device *>(this)->*entry->handler)(buffer);
+        return;
+      }
+    }
+    this->process_unknown_omnik_message(Device::LOG_TAG, control_code,
+                                        function_code, buffer);
+  }
+
+  /**
+   * Check whether the table of message handlers is sorted by message id.
+   */
+  static constexpr bool is_sorted_by_message_id() {
+    for (size_t i = 1; i < std::size(Device::MESSAGE_HANDLERS); i++) {
+      if (Device::MESSAGE_HANDLERS[i].message_id <
+          Device::MESSAGE_HANDLERS[i - 1].message_id) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Process an Omnik message that contains no data.
+   *
+   * @param buffer The data of the message.
+   *               (no data)
+   */
+  void omnik_message_no_data(BigEndianReader &buffer) {}
+};
+
+} // namespace omnik_base
+} // namespace esphome
@@ -0,0 +1,79 @@
+#include "omnik_discovery.h"
+#include "esphome/core/log.h"
+#include "omnik_base.h"
+
+#include <algorithm>
+
+namespace esphome {
+namespace omnik_base {
+
+// The definition of the constant, because std::min() binds it to a reference.
+const size_t UnknownMessages::MAX_DATA_SIZE;
+
+/**
+ * @see the header file.
+ */
+bool UnknownMessages::record(uint8_t control_code, uint8_t function_code,
+                             BigEndianReader &buffer) {
+  uint16_t message_id = OMNIK_MESSAGE_ID(control_code, function_code);
+
+  for (size_t i = 0; i < this->nr_of_entries_; i++) {
+    Entry &entry = this->entries_[i];
+    if (entry.message_id == message_id) {
+      entry.count++;
+      copy(buffer, entry.last);
+      return false;
+    }
+  }
+
+  if (this->nr_of_entries_ == MAX_MESSAGES) {
+    this->nr_of_dropped_++;
+    return true;
+  }
+  Entry &entry = this->entries_[this->nr_of_entries_++];
+  entry.message_id = message_id;
+  entry.count = 1;
+  copy(buffer, entry.first);
+  entry.last = entry.first;
+  return true;
+}
+
+/**
+ * @see the header file.
+ */
+void UnknownMessages::dump(const char *const tag) const {
+  if (this->nr_of_entries_ == 0) {
+    return;
+  }
+  ESP_LOGCONFIG(tag, "  Unknown messages:");
+  for (size_t i = 0; i < this->nr_of_entries_; i++) {
+    const Entry &entry = this->entries_[i];
+    size_t first_size = std::min<size_t>(entry.first.size, MAX_DATA_SIZE);
+    size_t last_size = std::min<size_t>(entry.last.size, MAX_DATA_SIZE);
+    ESP_LOGCONFIG(tag, "    0x%02X/0x%02X: count=%u size=%u",
+                  entry.message_id >> 8, entry.message_id & 0xFF,
+                  (unsigned) entry.count, entry.last.size);
+    ESP_LOGCONFIG(tag, "      first: %s",
+                  to_hex(entry.first.bytes, first_size, ':').c_str());
+    ESP_LOGCONFIG(tag, "      last:  %s",
+                  to_hex(entry.last.bytes, last_size, ':').c_str());
+  }
+  if (this->nr_of_dropped_ > 0) {
+    ESP_LOGCONFIG(tag, "    Not recorded: %u",
+                  (unsigned) this->nr_of_dropped_);
+  }
+}
+
+/**
+ * @see the header file.
+ */
+void UnknownMessages::copy(BigEndianReader &buffer, Data &data) {
+  size_t size = buffer.get_remaining();
+  data.size = size;
+  for (size_t i = 0; i < size && i < MAX_DATA_SIZE; i++) {
+    data.bytes[i] = buffer.get_uint8();
+  }
+}
+
+} // namespace omnik_base
+} // namespace esphome
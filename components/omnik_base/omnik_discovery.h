@@ -0,0 +1,140 @@
+#pragma once
+
+#include "esphome/core/log.h"
+#include "omnik_frame.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace omnik_base {
+
+/**
+ * Keeps track of the Omnik messages that are received but not known. For each
+ * unknown message the number of times it is received and the first and last
+ * data of the message are kept, so that the message can be reverse engineered
+ * from the traffic of a production system.
+ *
+ * The table has a fixed size, so it never allocates memory.
+ */
+class UnknownMessages {
+public:
+  // The maximum number of unknown messages that are kept.
+  static const size_t MAX_MESSAGES = 8;
+  // The maximum number of data bytes that are kept of a message.
+  static const size_t MAX_DATA_SIZE = 32;
+
+  /**
+   * Record a received unknown message.
+   *
+   * @param control_code The control code.
+   * @param function_code The function code.
+   * @param buffer The data of the message.
+   * @return True in case this message wasn't seen before, False otherwise.
+   */
+  bool record(uint8_t control_code, uint8_t function_code,
+              BigEndianReader &buffer);
+
+  /**
+   * Log all the unknown messages that have been received.
+   *
+   * @param tag The tag to use for the log messages.
+   */
+  void dump(const char *const tag) const;
+
+private:
+  /**
+   * The data of a message.
+   */
+  struct Data {
+    // The size of the data of the message (can be larger than MAX_DATA_SIZE).
+    uint8_t size;
+    // The first MAX_DATA_SIZE bytes of the data.
+    uint8_t bytes[MAX_DATA_SIZE];
+  };
+
+  /**
+   * The statistics of an unknown message.
+   */
+  struct Entry {
+    // The message id (see OMNIK_MESSAGE_ID).
+    uint16_t message_id;
+    // The number of times this message has been received.
+    uint32_t count;
+    // The data of the first received message.
+    Data first;
+    // The data of the last received message.
+    Data last;
+  };
+
+  // The unknown messages.
+  Entry entries_[MAX_MESSAGES];
+  // The number of used entries.
+  size_t nr_of_entries_{0};
+  // The number of unknown messages that didn't fit in the table.
+  uint32_t nr_of_dropped_{0};
+
+  /**
+   * Copy the remaining data of the buffer.
+   */
+  static void copy(BigEndianReader &buffer, Data &data);
+};
+
+/**
+ * Keeps track of which bytes of a data region change over time. This is used
+ * for the regions of a message that aren't decoded yet, to find the offsets
+ * that actually contain a value.
+ *
+ * @tparam N The number of bytes in the region.
+ */
+template <size_t N> class ByteVariance {
+public:
+  /**
+   * Track the bytes of the region.
+   *
+   * @param bytes The bytes of the region (N bytes).
+   */
+  void track(const uint8_t bytes[]) {
+    if (this->count_ == 0) {
+      for (size_t i = 0; i < N; i++) {
+        this->first_[i] = bytes[i];
+      }
+    }
+    for (size_t i = 0; i < N; i++) {
+      this->changed_bits_[i] |= this->first_[i] ^ bytes[i];
+    }
+    this->count_++;
+  }
+
+  /**
+   * Log the bytes of the region that have changed.
+   *
+   * @param tag The tag to use for the log messages.
+   * @param name The name of the region.
+   * @param offset The offset of the region in the message.
+   */
+  void dump(const char *const tag, const char *name, size_t offset) const {
+    if (this->count_ == 0) {
+      return;
+    }
+    ESP_LOGCONFIG(tag, "  %s (%u samples):", name, (unsigned) this->count_);
+    for (size_t i = 0; i < N; i++) {
+      if (this->changed_bits_[i] != 0) {
+        ESP_LOGCONFIG(tag, "    data[%u]: first=0x%02X changed_bits=0x%02X",
+                      (unsigned) (offset + i), this->first_[i],
+                      this->changed_bits_[i]);
+      }
+    }
+  }
+
+private:
+  // The number of times the region has been tracked.
+  uint32_t count_{0};
+  // The bytes of the first time the region was tracked.
+  uint8_t first_[N];
+  // The bits of each byte that have changed since the first time.
+  uint8_t changed_bits_[N]{};
+};
+
+} // namespace omnik_base
+} // namespace esphome
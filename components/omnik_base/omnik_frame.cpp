@@ -0,0 +1,254 @@
+#include "omnik_frame.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define OMNIK_SCAN_X86
+#endif
+
+namespace esphome {
+namespace omnik_base {
+
+/**
+ * Calculate the checksum, one byte at a time.
+ */
+static uint16_t calculate_checksum_scalar(const uint8_t buffer[], size_t size) {
+  uint16_t checksum = 0;
+  for (size_t index = 0; index < size; index++) {
+    checksum += buffer[index];
+  }
+  return checksum;
+}
+
+/**
+ * Find the start bytes, one byte at a time.
+ */
+static size_t find_frame_start_scalar(const uint8_t buffer[], size_t size) {
+  for (size_t index = 0; index + 1 < size; index++) {
+    if (buffer[index] == FRAME_START && buffer[index + 1] == FRAME_START)
+      return index;
+  }
+  return size;
+}
+
+#ifdef OMNIK_SCAN_X86
+
+/**
+ * Calculate the checksum, 16 bytes at a time.
+ */
+__attribute__((target("sse2"))) static uint16_t
+calculate_checksum_sse2(const uint8_t buffer[], size_t size) {
+  // The sum of absolute differences with zero adds 8 bytes into each half.
+  const __m128i zero = _mm_setzero_si128();
+  __m128i sum = zero;
+  size_t index = 0;
+  for (; index + 16 <= size; index += 16) {
+    __m128i bytes = _mm_loadu_si128((const __m128i *) (buffer + index));
+    sum = _mm_add_epi64(sum, _mm_sad_epu8(bytes, zero));
+  }
+  uint16_t checksum = _mm_cvtsi128_si32(sum) +
+                      _mm_cvtsi128_si32(_mm_unpackhi_epi64(sum, sum));
+  return checksum + calculate_checksum_scalar(buffer + index, size - index);
+}
+
+/**
+ * Find the start bytes, 16 positions at a time.
+ */
+__attribute__((target("sse2"))) static size_t
+find_frame_start_sse2(const uint8_t buffer[], size_t size) {
+  const __m128i start = _mm_set1_epi8(FRAME_START);
+  size_t index = 0;
+  for (; index + 17 <= size; index += 16) {
+    __m128i first = _mm_loadu_si128((const __m128i *) (buffer + index));
+    __m128i second = _mm_loadu_si128((const __m128i *) (buffer + index + 1));
+    unsigned mask = _mm_movemask_epi8(_mm_and_si128(
+        _mm_cmpeq_epi8(first, start), _mm_cmpeq_epi8(second, start)));
+    if (mask != 0)
+      return index + __builtin_ctz(mask);
+  }
+  return index + find_frame_start_scalar(buffer + index, size - index);
+}
+
+/**
+ * Calculate the checksum, 32 bytes at a time.
+ */
+__attribute__((target("avx2"))) static uint16_t
+calculate_checksum_avx2(const uint8_t buffer[], size_t size) {
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i sum = zero;
+  size_t index = 0;
+  for (; index + 32 <= size; index += 32) {
+    __m256i bytes = _mm256_loadu_si256((const __m256i *) (buffer + index));
+    sum = _mm256_add_epi64(sum, _mm256_sad_epu8(bytes, zero));
+  }
+  __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sum),
+                               _mm256_extracti128_si256(sum, 1));
+  uint16_t checksum = _mm_cvtsi128_si32(half) +
+                      _mm_cvtsi128_si32(_mm_unpackhi_epi64(half, half));
+  // The rest is scalar, because mixing the SSE and AVX instructions is slow.
+  return checksum + calculate_checksum_scalar(buffer + index, size - index);
+}
+
+/**
+ * Find the start bytes, 32 positions at a time.
+ */
+__attribute__((target("avx2"))) static size_t
+find_frame_start_avx2(const uint8_t buffer[], size_t size) {
+  const __m256i start = _mm256_set1_epi8(FRAME_START);
+  size_t index = 0;
+  for (; index + 33 <= size; index += 32) {
+    __m256i first = _mm256_loadu_si256((const __m256i *) (buffer + index));
+    __m256i second =
+        _mm256_loadu_si256((const __m256i *) (buffer + index + 1));
+    unsigned mask = _mm256_movemask_epi8(_mm256_and_si256(
+        _mm256_cmpeq_epi8(first, start), _mm256_cmpeq_epi8(second, start)));
+    if (mask != 0)
+      return index + __builtin_ctz(mask);
+  }
+  return index + find_frame_start_scalar(buffer + index, size - index);
+}
+
+#endif // OMNIK_SCAN_X86
+
+/**
+ * The functions of an implementation.
+ */
+struct ScanKernelInfo {
+  // The name of the implementation.
+  const char *name;
+  // Calculate the checksum.
+  uint16_t (*calculate_checksum)(const uint8_t buffer[], size_t size);
+  // Find the start bytes.
+  size_t (*find_frame_start)(const uint8_t buffer[], size_t size);
+};
+
+// The implementations (in the order of ScanKernel).
+static const ScanKernelInfo SCAN_KERNELS[] = {
+    {"scalar", calculate_checksum_scalar, find_frame_start_scalar},
+#ifdef OMNIK_SCAN_X86
+    {"sse2", calculate_checksum_sse2, find_frame_start_sse2},
+    {"avx2", calculate_checksum_avx2, find_frame_start_avx2},
+#else
+    {"sse2", nullptr, nullptr},
+    {"avx2", nullptr, nullptr},
+#endif
+};
+
+/**
+ * Get the fastest supported implementation.
+ */
+static ScanKernel get_default_scan_kernel() {
+  for (uint8_t kernel = NR_OF_SCAN_KERNELS; kernel-- > 0;) {
+    if (is_scan_kernel_supported((ScanKernel) kernel))
+      return (ScanKernel) kernel;
+  }
+  return SCAN_KERNEL_SCALAR;
+}
+
+// The implementation that is used.
+static ScanKernel scan_kernel = get_default_scan_kernel();
+
+/**
+ * @see the header file.
+ */
+const char *get_scan_kernel_name(ScanKernel kernel) {
+  return SCAN_KERNELS[kernel].name;
+}
+
+/**
+ * @see the header file.
+ */
+bool is_scan_kernel_supported(ScanKernel kernel) {
+  switch (kernel) {
+  case SCAN_KERNEL_SCALAR:
+    return true;
+#ifdef OMNIK_SCAN_X86
+  case SCAN_KERNEL_SSE2:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+  case SCAN_KERNEL_AVX2:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+  default:
+    return false;
+  }
+}
+
+/**
+ * @see the header file.
+ */
+ScanKernel get_scan_kernel() { return scan_kernel; }
+
+/**
+ * @see the header file.
+ */
+bool set_scan_kernel(ScanKernel kernel) {
+  if (!is_scan_kernel_supported(kernel))
+    return false;
+  scan_kernel = kernel;
+  return true;
+}
+
+/**
+ * @see the header file.
+ */
+uint16_t calculate_checksum(const uint8_t buffer[], size_t size) {
+  return SCAN_KERNELS[scan_kernel].calculate_checksum(buffer, size);
+}
+
+/**
+ * @see the header file.
+ */
+size_t find_frame_start(const uint8_t buffer[], size_t size) {
+  return SCAN_KERNELS[scan_kernel].find_frame_start(buffer, size);
+}
+
+/**
+ * @see the header file.
+ */
+FrameStatus parse_frame(const uint8_t buffer[], size_t size, Frame &frame) {
+  // Check the start bytes.
+  if (size < 2)
+    return FRAME_INCOMPLETE;
+  if (buffer[0] != FRAME_START || buffer[1] != FRAME_START)
+    return FRAME_INVALID;
+
+  // Check the header bytes.
+  if (size < FRAME_HEADER_SIZE + FRAME_CHECKSUM_SIZE)
+    return FRAME_INCOMPLETE;
+  frame.sender_address = (buffer[2] << 8) + buffer[3];
+  frame.receiver_address = (buffer[4] << 8) + buffer[5];
+  frame.control_code = buffer[6];
+  frame.function_code = buffer[7];
+  frame.data_size = buffer[8];
+  frame.data = buffer + FRAME_HEADER_SIZE;
+
+  // Get the expected check sum.
+  size_t checksum_offset = FRAME_HEADER_SIZE + frame.data_size;
+  if (size < checksum_offset + FRAME_CHECKSUM_SIZE)
+    return FRAME_INCOMPLETE;
+  frame.expected_checksum =
+      (buffer[checksum_offset] << 8) + buffer[checksum_offset + 1];
+
+  // Check the checksum.
+  frame.actual_checksum = calculate_checksum(buffer, checksum_offset);
+  if (frame.actual_checksum != frame.expected_checksum)
+    return FRAME_CHECKSUM_ERROR;
+
+  return FRAME_OK;
+}
+
+/**
+ * @see the header file.
+ */
+void find_frames(const uint8_t buffer[], size_t size,
+                 std::vector<size_t> &offsets) {
+  scan_frames(buffer, size, 0, size,
+              [&offsets](size_t position, const Frame &, FrameStatus status) {
+                if (status == FRAME_OK)
+                  offsets.push_back(position);
+              });
+}
+
+} // namespace omnik_base
+} // namespace esphome
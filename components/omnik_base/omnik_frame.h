@@ -0,0 +1,231 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// This file doesn't depend on ESPHome, so that it can also be used by the
+// host tools.
+
+namespace esphome {
+namespace omnik_base {
+
+// The value of the two start bytes of an Omnik message.
+static const uint8_t FRAME_START = 0x3A;
+// The size of the header of an Omnik message (up to and including the data
+// size).
+static const size_t FRAME_HEADER_SIZE = 9;
+// The size of the checksum of an Omnik message.
+static const size_t FRAME_CHECKSUM_SIZE = 2;
+// The maximum size of an Omnik message.
+static const size_t MAX_FRAME_SIZE =
+    FRAME_HEADER_SIZE + 255 + FRAME_CHECKSUM_SIZE;
+
+/**
+ * The result of parsing the bytes of an Omnik message.
+ */
+enum FrameStatus : uint8_t {
+  // More bytes are needed.
+  FRAME_INCOMPLETE,
+  // The bytes don't start with the start bytes.
+  FRAME_INVALID,
+  // The message is complete, but the checksum doesn't match.
+  FRAME_CHECKSUM_ERROR,
+  // The message is complete and correct.
+  FRAME_OK,
+};
+
+/**
+ * An Omnik message. The data refers to the parsed bytes.
+ *
+ * An Omnik message has the following format:
+ * * buffer[0 .. 1] Start bytes (value 0x3A).
+ * * buffer[2 .. 3] Sender address.
+ * * buffer[4 .. 5] Receiver address.
+ * * buffer[6] Control code.
+ * * buffer[7] Function code.
+ * * buffer[8] Data size.
+ * * buffer[9 .. 9 + Data size - 1] Data.
+ * * buffer[9 + Data size .. 9 + Data size + 1] Check sum.
+ */
+struct Frame {
+  uint16_t sender_address;
+  uint16_t receiver_address;
+  uint8_t control_code;
+  uint8_t function_code;
+  uint8_t data_size;
+  const uint8_t *data;
+  // The checksum in the message.
+  uint16_t expected_checksum;
+  // The checksum of the received bytes.
+  uint16_t actual_checksum;
+
+  /**
+   * Get the size of the complete message.
+   */
+  size_t size() const {
+    return FRAME_HEADER_SIZE + this->data_size + FRAME_CHECKSUM_SIZE;
+  }
+};
+
+/**
+ * The implementations of finding the start bytes and calculating the checksum.
+ * The vector implementations are only available on x86 hosts, the scalar
+ * implementation is available everywhere.
+ */
+enum ScanKernel : uint8_t {
+  SCAN_KERNEL_SCALAR,
+  SCAN_KERNEL_SSE2,
+  SCAN_KERNEL_AVX2,
+};
+
+// The number of implementations.
+static const uint8_t NR_OF_SCAN_KERNELS = SCAN_KERNEL_AVX2 + 1;
+
+/**
+ * Get the name of an implementation.
+ */
+const char *get_scan_kernel_name(ScanKernel kernel);
+
+/**
+ * Check whether an implementation is supported by this CPU.
+ */
+bool is_scan_kernel_supported(ScanKernel kernel);
+
+/**
+ * Get the implementation that is used. By default the fastest supported
+ * implementation is used.
+ */
+ScanKernel get_scan_kernel();
+
+/**
+ * Select the implementation that is used. This isn't thread safe, so it should
+ * be done before the scanning is started.
+ *
+ * @param kernel The implementation.
+ * @return False in case the implementation isn't supported.
+ */
+bool set_scan_kernel(ScanKernel kernel);
+
+/**
+ * Calculate the checksum of a number of bytes.
+ *
+ * @param buffer The bytes.
+ * @param size The number of bytes.
+ * @return The sum of the bytes.
+ */
+uint16_t calculate_checksum(const uint8_t buffer[], size_t size);
+
+/**
+ * Find the start bytes of an Omnik message.
+ *
+ * @param buffer The bytes.
+ * @param size The number of bytes.
+ * @return The position of the first two start bytes, or size in case there
+ *         are none.
+ */
+size_t find_frame_start(const uint8_t buffer[], size_t size);
+
+/**
+ * Parse the bytes of an Omnik message.
+ *
+ * @param buffer The bytes, starting with the first start byte.
+ * @param size The number of bytes (can be more than the message).
+ * @param frame The parsed message (in case of FRAME_OK and
+ *              FRAME_CHECKSUM_ERROR).
+ * @return The result of parsing the bytes.
+ */
+FrameStatus parse_frame(const uint8_t buffer[], size_t size, Frame &frame);
+
+/**
+ * Scan a number of bytes for Omnik messages.
+ *
+ * A correct message is skipped as a whole, otherwise the scan continues with
+ * the next byte, so that the scan resynchronises on the next start bytes. The
+ * last message may extend beyond the end of the scanned positions.
+ *
+ * @param buffer The bytes.
+ * @param size The number of bytes.
+ * @param begin The first position that is scanned.
+ * @param end The position after the last position that is scanned.
+ * @param handler Called as handler(position, frame, status) for each message
+ *                with status FRAME_OK or FRAME_CHECKSUM_ERROR.
+ * @return The position after the scan.
+ */
+template <typename Handler>
+size_t scan_frames(const uint8_t buffer[], size_t size, size_t begin,
+                   size_t end, Handler &&handler) {
+  size_t position = begin;
+  while (position < end) {
+    // Both start bytes must be before the end of the buffer, the first one
+    // must be before the end of the scanned positions.
+    size_t search_end = end < size ? end + 1 : size;
+    position += find_frame_start(buffer + position, search_end - position);
+    if (position >= end)
+      break;
+
+    Frame frame;
+    size_t remaining = size - position;
+    FrameStatus status = parse_frame(
+        buffer + position,
+        remaining < MAX_FRAME_SIZE ? remaining : MAX_FRAME_SIZE, frame);
+    if (status == FRAME_OK || status == FRAME_CHECKSUM_ERROR)
+      handler(position, frame, status);
+    position += status == FRAME_OK ? frame.size() : 1;
+  }
+  return position < end ? end : position;
+}
+
+/**
+ * Find all the correct Omnik messages in a number of bytes.
+ *
+ * @param buffer The bytes.
+ * @param size The number of bytes.
+ * @param offsets The positions of the correct messages are appended to it.
+ */
+void find_frames(const uint8_t buffer[], size_t size,
+                 std::vector<size_t> &offsets);
+
+/**
+ * Reads big endian values from a number of bytes without copying them. The
+ * components and the host tools decode the data of a message with it straight
+ * from the bytes of the frame.
+ */
+class BigEndianReader {
+public:
+  BigEndianReader(const uint8_t data[], size_t size)
+      : data_(data), size_(size) {}
+
+  size_t get_remaining() const { return this->size_ - this->position_; }
+  size_t get_limit() const { return this->size_; }
+  size_t get_position() const { return this->position_; }
+  void set_position(size_t position) { this->position_ = position; }
+
+  uint8_t get_uint8() { return this->data_[this->position_++]; }
+  uint16_t get_uint16() { return (uint16_t) get(2); }
+  int16_t get_int16() { return (int16_t) get(2); }
+  uint32_t get_uint24() { return get(3); }
+  uint32_t get_uint32() { return get(4); }
+
+private:
+  // The bytes.
+  const uint8_t *data_;
+  // The number of bytes.
+  size_t size_;
+  // The position of the next byte.
+  size_t position_{0};
+
+  /**
+   * Get a big endian value of a number of bytes.
+   */
+  uint32_t get(size_t length) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < length; i++) {
+      value = (value << 8) | this->data_[this->position_++];
+    }
+    return value;
+  }
+};
+
+} // namespace omnik_base
+} // namespace esphome
@@ -0,0 +1,47 @@
+#include "omnik_frame_assembler.h"
+
+namespace esphome {
+namespace omnik_base {
+
+/**
+ * @see the header file.
+ */
+bool FrameAssembler::check_timeout(uint32_t now) {
+  if (now - this->last_received_time_ <= this->timeout_) {
+    return false;
+  }
+  bool is_discarded = this->size_ > 0 && !this->is_complete_;
+  this->size_ = 0;
+  this->is_complete_ = false;
+  this->last_received_time_ = now;
+  return is_discarded;
+}
+
+/**
+ * @see the header file.
+ */
+FrameStatus FrameAssembler::add_byte(uint8_t byte, uint32_t now) {
+  if (this->is_complete_) {
+    this->size_ = 0;
+    this->is_complete_ = false;
+  }
+  this->last_received_time_ = now;
+  this->buffer_[this->size_++] = byte;
+
+  FrameStatus status = parse_frame(this->buffer_, this->size_, this->frame_);
+  switch (status) {
+  case FRAME_INCOMPLETE:
+    break;
+  case FRAME_INVALID:
+    this->size_ = 0;
+    break;
+  case FRAME_CHECKSUM_ERROR:
+  case FRAME_OK:
+    this->is_complete_ = true;
+    break;
+  }
+  return status;
+}
+
+} // namespace omnik_base
+} // namespace esphome
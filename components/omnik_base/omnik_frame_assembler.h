@@ -0,0 +1,89 @@
+#pragma once
+
+#include "omnik_frame.h"
+
+// This file doesn't depend on ESPHome, so that it can also be used by the
+// host tools.
+
+namespace esphome {
+namespace omnik_base {
+
+/**
+ * Assembles the received bytes into Omnik messages.
+ *
+ * The bytes are collected until they form a complete message. A message is
+ * complete as soon as the number of data bytes of its header (and the
+ * checksum) have been received, so back-to-back messages are separated
+ * without waiting for a gap. The bytes are discarded in case they can't be
+ * the start of a message, in case the message is complete (correct or not)
+ * and in case the next byte isn't received within the timeout (the gap
+ * between two messages).
+ */
+class FrameAssembler {
+public:
+  /**
+   * Set the maximum time between two bytes of the same message.
+   *
+   * @param timeout The timeout (in the unit of the times given to
+   *                check_timeout() and add_byte()).
+   */
+  void set_timeout(uint32_t timeout) { this->timeout_ = timeout; }
+
+  /**
+   * Discard the received bytes in case the timeout has passed since the last
+   * byte was received.
+   *
+   * @param now The current time.
+   * @return True in case received bytes have been discarded.
+   */
+  bool check_timeout(uint32_t now);
+
+  /**
+   * Add a received byte.
+   *
+   * @param byte The received byte.
+   * @param now The current time.
+   * @return FRAME_OK or FRAME_CHECKSUM_ERROR in case the message is complete.
+   *         Then the message is available until the next byte is added.
+   *         FRAME_INVALID in case the bytes have been discarded and
+   *         FRAME_INCOMPLETE in case more bytes are needed.
+   */
+  FrameStatus add_byte(uint8_t byte, uint32_t now);
+
+  /**
+   * Check whether a message is being received (not complete yet).
+   */
+  bool is_receiving() const { return this->size_ > 0 && !this->is_complete_; }
+
+  /**
+   * Get the parsed complete message.
+   */
+  const Frame &get_frame() const { return this->frame_; }
+
+  /**
+   * Get the bytes of the (incomplete) message.
+   */
+  const uint8_t *get_data() const { return this->buffer_; }
+
+  /**
+   * Get the number of bytes of the (incomplete) message.
+   */
+  size_t get_size() const { return this->size_; }
+
+private:
+  // The received bytes.
+  uint8_t buffer_[MAX_FRAME_SIZE];
+  // The number of received bytes.
+  size_t size_{0};
+  // True in case the received bytes are a complete message.
+  bool is_complete_{false};
+  // The parsed complete message.
+  Frame frame_{};
+  // The maximum time between two bytes of the same message.
+  uint32_t timeout_{0};
+  // The time at which the last byte has been received.
+  uint32_t last_received_time_{0};
+};
+
+} // namespace omnik_base
+} // namespace esphome
@@ -0,0 +1,228 @@
+#include "omnik_history.h"
+
+#include <cstring>
+
+namespace esphome {
+namespace omnik_base {
+
+/**
+ * Write an unsigned varint.
+ *
+ * @return The number of bytes that have been written.
+ */
+static size_t put_varint(uint8_t buffer[], uint32_t value) {
+  size_t length = 0;
+  while (value >= 0x80) {
+    buffer[length++] = (value & 0x7F) | 0x80;
+    value >>= 7;
+  }
+  buffer[length++] = value;
+  return length;
+}
+
+/**
+ * Read an unsigned varint.
+ *
+ * @return The number of bytes that have been read.
+ */
+static size_t get_varint(const uint8_t buffer[], uint32_t &value) {
+  size_t length = 0;
+  value = 0;
+  for (unsigned shift = 0; shift < 35; shift += 7) {
+    uint8_t byte = buffer[length++];
+    value |= (uint32_t) (byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      break;
+    }
+  }
+  return length;
+}
+
+/**
+ * Convert a signed value to an unsigned value with small values for small
+ * (positive and negative) values.
+ */
+static uint32_t to_zigzag(int32_t value) {
+  return ((uint32_t) value << 1) ^ (uint32_t) (value >> 31);
+}
+
+/**
+ * The inverse of to_zigzag().
+ */
+static int32_t from_zigzag(uint32_t value) {
+  return (int32_t) (value >> 1) ^ -(int32_t) (value & 1);
+}
+
+/**
+ * @see the header file.
+ */
+void DeltaHistory::init(size_t size, size_t nr_of_values) {
+  size_t nr_of_blocks = size / BLOCK_SIZE;
+  if (nr_of_blocks < 2) {
+    nr_of_blocks = 2;
+  }
+  this->nr_of_values_ = nr_of_values < MAX_VALUES ? nr_of_values : MAX_VALUES;
+  this->data_.assign(nr_of_blocks * BLOCK_SIZE, 0);
+  this->blocks_.assign(nr_of_blocks, Block{});
+  this->first_block_ = 0;
+  this->nr_of_used_blocks_ = 0;
+}
+
+/**
+ * @see the header file.
+ */
+size_t DeltaHistory::get_nr_of_samples() const {
+  size_t nr_of_samples = 0;
+  for (size_t i = 0; i < this->nr_of_used_blocks_; i++) {
+    nr_of_samples +=
+        this->blocks_[(this->first_block_ + i) % this->blocks_.size()]
+            .nr_of_samples;
+  }
+  return nr_of_samples;
+}
+
+/**
+ * @see the header file.
+ */
+void DeltaHistory::append(uint32_t timestamp, const int32_t values[]) {
+  if (this->blocks_.empty()) {
+    return;
+  }
+  uint8_t sample[5 * (MAX_VALUES + 1)];
+
+  // Add the difference with the last sample to the newest block, in case it
+  // fits.
+  if (this->nr_of_used_blocks_ > 0) {
+    Block &block =
+        this->blocks_[(this->first_block_ + this->nr_of_used_blocks_ - 1) %
+                      this->blocks_.size()];
+    size_t length = encode(sample, timestamp, values, false);
+    if (block.length + length <= BLOCK_SIZE) {
+      size_t index = &block - this->blocks_.data();
+      memcpy(&this->data_[index * BLOCK_SIZE + block.length], sample, length);
+      block.length += length;
+      block.nr_of_samples++;
+      this->last_timestamp_ = timestamp;
+      memcpy(this->last_values_, values, this->nr_of_values_ * sizeof(int32_t));
+      return;
+    }
+  }
+
+  // Otherwise start a new block with the absolute values, and overwrite the
+  // oldest block in case the history is full.
+  if (this->nr_of_used_blocks_ == this->blocks_.size()) {
+    this->first_block_ = (this->first_block_ + 1) % this->blocks_.size();
+    this->nr_of_used_blocks_--;
+  }
+  size_t index =
+      (this->first_block_ + this->nr_of_used_blocks_) % this->blocks_.size();
+  this->nr_of_used_blocks_++;
+  Block &block = this->blocks_[index];
+  size_t length = encode(sample, timestamp, values, true);
+  memcpy(&this->data_[index * BLOCK_SIZE], sample, length);
+  block.sequence = this->next_sequence_++;
+  block.length = length;
+  block.nr_of_samples = 1;
+  this->last_timestamp_ = timestamp;
+  memcpy(this->last_values_, values, this->nr_of_values_ * sizeof(int32_t));
+}
+
+/**
+ * @see the header file.
+ */
+const DeltaHistory::Block *DeltaHistory::find_block(uint32_t sequence,
+                                                    size_t &index) const {
+  if (this->nr_of_used_blocks_ == 0) {
+    return nullptr;
+  }
+  uint32_t first_sequence = this->blocks_[this->first_block_].sequence;
+  uint32_t offset = sequence - first_sequence;
+  if (offset >= this->nr_of_used_blocks_) {
+    return nullptr;
+  }
+  index = (this->first_block_ + offset) % this->blocks_.size();
+  return &this->blocks_[index];
+}
+
+/**
+ * @see the header file.
+ */
+size_t DeltaHistory::encode(uint8_t buffer[], uint32_t timestamp,
+                            const int32_t values[], bool absolute) const {
+  size_t length = 0;
+  if (absolute) {
+    length += put_varint(buffer + length, timestamp);
+    for (size_t i = 0; i < this->nr_of_values_; i++) {
+      length += put_varint(buffer + length, to_zigzag(values[i]));
+    }
+  } else {
+    length += put_varint(buffer + length, timestamp - this->last_timestamp_);
+    for (size_t i = 0; i < this->nr_of_values_; i++) {
+      length += put_varint(
+          buffer + length,
+          to_zigzag((int32_t) ((uint32_t) values[i] - this->last_values_[i])));
+    }
+  }
+  return length;
+}
+
+/**
+ * @see the header file.
+ */
+DeltaHistory::Reader::Reader(const DeltaHistory &history) : history_(history) {
+  this->sequence_ = history.nr_of_used_blocks_ > 0
+                        ? history.blocks_[history.first_block_].sequence
+                        : history.next_sequence_;
+}
+
+/**
+ * @see the header file.
+ */
+bool DeltaHistory::Reader::next(uint32_t &timestamp, int32_t values[]) {
+  const DeltaHistory &history = this->history_;
+  size_t index;
+  const Block *block = history.find_block(this->sequence_, index);
+
+  // Continue with the next block at the end of this one, and with the oldest
+  // block in case this block has been overwritten.
+  if (block != nullptr && this->offset_ >= block->length &&
+      this->sequence_ + 1 != history.next_sequence_) {
+    this->sequence_++;
+    this->offset_ = 0;
+    block = history.find_block(this->sequence_, index);
+  }
+  if (block == nullptr) {
+    if (history.nr_of_used_blocks_ == 0 ||
+        this->sequence_ - history.blocks_[history.first_block_].sequence <
+            (uint32_t) 0x80000000) {
+      return false;
+    }
+    this->sequence_ = history.blocks_[history.first_block_].sequence;
+    this->offset_ = 0;
+    block = history.find_block(this->sequence_, index);
+  }
+  if (this->offset_ >= block->length) {
+    return false;
+  }
+
+  const uint8_t *data = &history.data_[index * BLOCK_SIZE + this->offset_];
+  size_t length = 0;
+  uint32_t value;
+  bool absolute = this->offset_ == 0;
+  length += get_varint(data + length, value);
+  this->timestamp_ = absolute ? value : this->timestamp_ + value;
+  for (size_t i = 0; i < history.nr_of_values_; i++) {
+    length += get_varint(data + length, value);
+    this->values_[i] =
+        absolute ? from_zigzag(value)
+                 : (int32_t) ((uint32_t) this->values_[i] + from_zigzag(value));
+  }
+  this->offset_ += length;
+
+  timestamp = this->timestamp_;
+  memcpy(values, this->values_, history.nr_of_values_ * sizeof(int32_t));
+  return true;
+}
+
+} // namespace omnik_base
+} // namespace esphome
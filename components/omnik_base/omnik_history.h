@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace esphome {
+namespace omnik_base {
+
+/**
+ * A compact history of samples. Each sample has a timestamp and a number of
+ * integer values.
+ *
+ * The samples are stored in a ring of fixed size blocks. Each block starts
+ * with a sample that contains the absolute values, followed by samples that
+ * contain the difference with the previous sample. All the numbers are stored
+ * as (zigzag) varints, so a sample with values that don't change much only
+ * takes a few bytes. When the history is full, then the oldest block is
+ * overwritten.
+ *
+ * Appending a sample only encodes that sample. The samples are only decoded
+ * when they are read.
+ */
+class DeltaHistory {
+public:
+  // The size of a block (in bytes).
+  static const size_t BLOCK_SIZE = 256;
+  // The maximum number of values of a sample.
+  static const size_t MAX_VALUES = 32;
+
+  /**
+   * Allocate the memory of the history.
+   *
+   * @param size The size of the history (in bytes).
+   * @param nr_of_values The number of values of each sample.
+   */
+  void init(size_t size, size_t nr_of_values);
+
+  /**
+   * Get the number of values of each sample.
+   */
+  size_t get_nr_of_values() const { return this->nr_of_values_; }
+
+  /**
+   * Get the size of the history (in bytes).
+   */
+  size_t get_size() const { return this->data_.size(); }
+
+  /**
+   * Get the number of samples in the history.
+   */
+  size_t get_nr_of_samples() const;
+
+  /**
+   * Append a sample to the history.
+   *
+   * @param timestamp The timestamp of the sample.
+   * @param values The values of the sample (get_nr_of_values() values).
+   */
+  void append(uint32_t timestamp, const int32_t values[]);
+
+  /**
+   * Reads the samples of a history, from the oldest to the newest sample.
+   *
+   * In case blocks are overwritten while they are read, then the reader
+   * continues with the oldest block that is still available.
+   */
+  class Reader {
+  public:
+    Reader(const DeltaHistory &history);
+
+    /**
+     * Read the next sample.
+     *
+     * @param timestamp The timestamp of the sample.
+     * @param values The values of the sample (get_nr_of_values() values).
+     * @return True in case a sample was read, False at the end.
+     */
+    bool next(uint32_t &timestamp, int32_t values[]);
+
+  private:
+    // The history that is read.
+    const DeltaHistory &history_;
+    // The sequence number of the block that is read.
+    uint32_t sequence_;
+    // The offset of the next sample in the block.
+    size_t offset_{0};
+    // The timestamp of the previous sample.
+    uint32_t timestamp_{0};
+    // The values of the previous sample.
+    int32_t values_[MAX_VALUES]{};
+  };
+
+private:
+  /**
+   * The administration of a block.
+   */
+  struct Block {
+    // The sequence number of the block.
+    uint32_t sequence;
+    // The number of bytes that are used.
+    uint16_t length;
+    // The number of samples in the block.
+    uint16_t nr_of_samples;
+  };
+
+  // The number of values of each sample.
+  size_t nr_of_values_{0};
+  // The data of all the blocks.
+  std::vector<uint8_t> data_;
+  // The administration of the blocks.
+  std::vector<Block> blocks_;
+  // The index of the oldest block.
+  size_t first_block_{0};
+  // The number of blocks that are used.
+  size_t nr_of_used_blocks_{0};
+  // The sequence number of the next block.
+  uint32_t next_sequence_{0};
+  // The timestamp of the last sample.
+  uint32_t last_timestamp_{0};
+  // The values of the last sample.
+  int32_t last_values_[MAX_VALUES]{};
+
+  /**
+   * Get the block with a sequence number.
+   *
+   * @return The block, or nullptr in case it isn't available (anymore).
+   */
+  const Block *find_block(uint32_t sequence, size_t &index) const;
+
+  /**
+   * Encode a sample.
+   *
+   * @return The number of bytes in the buffer.
+   */
+  size_t encode(uint8_t buffer[], uint32_t timestamp, const int32_t values[],
+                bool absolute) const;
+};
+
+} // namespace omnik_base
+} // namespace esphome
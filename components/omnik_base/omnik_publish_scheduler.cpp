@@ -0,0 +1,97 @@
+#include "omnik_publish_scheduler.h"
+#include "esphome/core/hal.h"
+
+namespace esphome {
+namespace omnik_base {
+
+/**
+ * @see the header file.
+ */
+size_t PublishScheduler::add_slot(sensor::Sensor *sensor) {
+  this->slots_.push_back({sensor, nullptr, 0.0f, std::string(), false});
+  return this->slots_.size() - 1;
+}
+
+/**
+ * @see the header file.
+ */
+size_t PublishScheduler::add_slot(text_sensor::TextSensor *text_sensor) {
+  this->slots_.push_back({nullptr, text_sensor, 0.0f, std::string(), false});
+  return this->slots_.size() - 1;
+}
+
+/**
+ * @see the header file.
+ */
+void PublishScheduler::stage(size_t slot, float value) {
+  Slot &entry = this->slots_[slot];
+  if (entry.sensor == nullptr) {
+    return;
+  }
+  entry.value = value;
+  this->set_pending(entry);
+}
+
+/**
+ * @see the header file.
+ */
+void PublishScheduler::stage(size_t slot, const char *state) {
+  Slot &entry = this->slots_[slot];
+  if (entry.text_sensor == nullptr) {
+    return;
+  }
+  entry.state.assign(state);
+  this->set_pending(entry);
+}
+
+/**
+ * @see the header file.
+ */
+void PublishScheduler::set_pending(Slot &slot) {
+  if (slot.is_pending) {
+    this->nr_of_overwritten_++;
+    return;
+  }
+  slot.is_pending = true;
+  this->nr_of_pending_++;
+}
+
+/**
+ * @see the header file.
+ */
+void PublishScheduler::flush() {
+  if (this->nr_of_pending_ == 0) {
+    return;
+  }
+  const uint32_t start = micros();
+  uint8_t nr_of_published = 0;
+  // The slots are visited round robin from where the previous flush stopped,
+  // so every slot is visited at most once.
+  for (size_t i = 0; i < this->slots_.size() && this->nr_of_pending_ > 0;
+       i++) {
+    Slot &slot = this->slots_[this->next_slot_];
+    this->next_slot_ = (this->next_slot_ + 1) % this->slots_.size();
+    if (!slot.is_pending) {
+      continue;
+    }
+    // The slot is cleared first, so that a value that is staged by a callback
+    // of the sensor is published by the next flush.
+    slot.is_pending = false;
+    this->nr_of_pending_--;
+    if (slot.sensor != nullptr) {
+      slot.sensor->publish_state(slot.value);
+    } else {
+      slot.text_sensor->publish_state(slot.state);
+    }
+    nr_of_published++;
+    if (nr_of_published >= this->batch_size_ ||
+        micros() - start >= this->time_budget_) {
+      break;
+    }
+  }
+  this->nr_of_published_ += nr_of_published;
+  this->nr_of_flushes_++;
+}
+
+} // namespace omnik_base
+} // namespace esphome
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "esphome/components/sensor/sensor.h"
+#include "esphome/components/text_sensor/text_sensor.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace omnik_base {
+
+/**
+ * Spreads the publishing of the decoded values over several loop iterations,
+ * so that one message doesn't call all the publish_state() (and with it the
+ * API subscribers, filters and automations) in one loop iteration.
+ *
+ * Every sensor has a slot in which its value is staged. The staged values are
+ * published by flush() in batches, in the order of the slots. A value that is
+ * staged again before it has been published overwrites the staged value, so a
+ * sensor never has more than one pending update.
+ */
+class PublishScheduler {
+public:
+  /**
+   * Set the maximum number of values that are published by one flush().
+   */
+  void set_batch_size(uint8_t batch_size) { this->batch_size_ = batch_size; }
+
+  /**
+   * Set the time after which flush() stops publishing (in microseconds). At
+   * least one value is published by every flush().
+   */
+  void set_time_budget(uint32_t time_budget) {
+    this->time_budget_ = time_budget;
+  }
+
+  /**
+   * Add a slot for a sensor.
+   *
+   * @param sensor The sensor (nullptr in case it isn't used).
+   * @return The slot.
+   */
+  size_t add_slot(sensor::Sensor *sensor);
+
+  /**
+   * Add a slot for a text sensor.
+   *
+   * @param text_sensor The text sensor (nullptr in case it isn't used).
+   * @return The slot.
+   */
+  size_t add_slot(text_sensor::TextSensor *text_sensor);
+
+  /**
+   * Stage the value of a sensor.
+   *
+   * @param slot The slot of the sensor.
+   * @param value The value.
+   */
+  void stage(size_t slot, float value);
+
+  /**
+   * Stage the state of a text sensor. The state is copied, so it may be a
+   * buffer on the stack.
+   *
+   * @param slot The slot of the text sensor.
+   * @param state The state.
+   */
+  void stage(size_t slot, const char *state);
+
+  /**
+   * Check whether there are staged values that haven't been published.
+   */
+  bool has_pending() const { return this->nr_of_pending_ > 0; }
+
+  /**
+   * Publish the next batch of staged values.
+   */
+  void flush();
+
+  /**
+   * Get the configuration and the statistics.
+   */
+  uint8_t get_batch_size() const { return this->batch_size_; }
+  uint32_t get_time_budget() const { return this->time_budget_; }
+  uint32_t get_nr_of_published() const { return this->nr_of_published_; }
+  uint32_t get_nr_of_overwritten() const { return this->nr_of_overwritten_; }
+  uint32_t get_nr_of_flushes() const { return this->nr_of_flushes_; }
+
+private:
+  /**
+   * The staged value of a sensor or text sensor.
+   */
+  struct Slot {
+    // The sensor (nullptr in case it is a text sensor).
+    sensor::Sensor *sensor;
+    // The text sensor (nullptr in case it is a sensor).
+    text_sensor::TextSensor *text_sensor;
+    // The staged value of the sensor.
+    float value;
+    // The staged state of the text sensor. It keeps its capacity, so staging
+    // only allocates the first time.
+    std::string state;
+    // True in case the staged value hasn't been published.
+    bool is_pending;
+  };
+
+  // The maximum number of values that are published by one flush().
+  uint8_t batch_size_{8};
+  // The time after which flush() stops publishing (in microseconds).
+  uint32_t time_budget_{2000};
+  // The slots of the sensors.
+  std::vector<Slot> slots_;
+  // The slot at which the next flush() starts.
+  size_t next_slot_{0};
+  // The number of slots with a staged value that hasn't been published.
+  size_t nr_of_pending_{0};
+  // The number of values that have been published.
+  uint32_t nr_of_published_{0};
+  // The number of staged values that were overwritten before they were
+  // published.
+  uint32_t nr_of_overwritten_{0};
+  // The number of flushes that published at least one value.
+  uint32_t nr_of_flushes_{0};
+
+  /**
+   * Mark a slot as pending.
+   */
+  void set_pending(Slot &slot);
+};
+
+} // namespace omnik_base
+} // namespace esphome
@@ -0,0 +1,99 @@
+#include "omnik_rx_task.h"
+
+#if defined(OMNIK_RX_TASK_THREAD)
+#include <chrono>
+#endif
+
+namespace esphome {
+namespace omnik_base {
+
+#if defined(ESP_PLATFORM)
+// The stack size of the task (in bytes).
+static const uint32_t TASK_STACK_SIZE = 4096;
+// The priority of the task, above the main loop and below WiFi.
+static const UBaseType_t TASK_PRIORITY = 5;
+// The core of the task (the main loop runs on core 1).
+static const BaseType_t TASK_CORE = 0;
+#endif
+
+/**
+ * @see the header file.
+ */
+bool RxTask::is_supported() {
+#if defined(ESP_PLATFORM) || defined(OMNIK_RX_TASK_THREAD)
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @see the header file.
+ */
+bool RxTask::start([[maybe_unused]] const char *name, Function function,
+                   void *argument) {
+  if (this->is_running_.load()) {
+    return false;
+  }
+  this->function_ = function;
+  this->argument_ = argument;
+  this->is_running_.store(true);
+
+#if defined(ESP_PLATFORM)
+  this->is_stopped_.store(false);
+  BaseType_t result = xTaskCreatePinnedToCore(
+      [](void *task) {
+        static_cast<RxTask *>(task)->run();
+        static_cast<RxTask *>(task)->is_stopped_.store(true);
+        vTaskDelete(nullptr);
+      },
+      name, TASK_STACK_SIZE, this, TASK_PRIORITY, nullptr, TASK_CORE);
+  if (result != pdPASS) {
+    this->is_running_.store(false);
+    this->is_stopped_.store(true);
+    return false;
+  }
+  return true;
+#elif defined(OMNIK_RX_TASK_THREAD)
+  this->thread_ = std::thread(&RxTask::run, this);
+  return true;
+#else
+  this->is_running_.store(false);
+  return false;
+#endif
+}
+
+/**
+ * @see the header file.
+ */
+void RxTask::stop() {
+  this->is_running_.store(false);
+#if defined(ESP_PLATFORM)
+  while (!this->is_stopped_.load()) {
+    vTaskDelay(1);
+  }
+#elif defined(OMNIK_RX_TASK_THREAD)
+  if (this->thread_.joinable()) {
+    this->thread_.join();
+  }
+#endif
+}
+
+/**
+ * @see the header file.
+ */
+void RxTask::run() {
+  while (this->is_running_.load()) {
+    if (this->function_(this->argument_)) {
+      continue;
+    }
+#if defined(ESP_PLATFORM)
+    vTaskDelay(1);
+#elif defined(OMNIK_RX_TASK_THREAD)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#endif
+  }
+}
+
+} // namespace omnik_base
+} // namespace esphome
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(ESP_PLATFORM)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <thread>
+#define OMNIK_RX_TASK_THREAD
+#endif
+
+// This file doesn't depend on ESPHome, so that it can also be used by the
+// host tools.
+
+namespace esphome {
+namespace omnik_base {
+
+/**
+ * A task that repeatedly calls a function until it is stopped. It is a
+ * FreeRTOS task on the ESP32 and a std::thread on a host. It isn't supported
+ * on the other platforms.
+ */
+class RxTask {
+public:
+  /**
+   * The function of the task.
+   *
+   * @param argument The argument given to start().
+   * @return False in case there was nothing to do, then the task sleeps for
+   *         a short while before the function is called again.
+   */
+  using Function = bool (*)(void *argument);
+
+  ~RxTask() { this->stop(); }
+
+  /**
+   * Check whether tasks are supported on this platform.
+   */
+  static bool is_supported();
+
+  /**
+   * Start the task.
+   *
+   * @param name The name of the task (only used by the FreeRTOS task).
+   * @param function The function of the task.
+   * @param argument The argument of the function.
+   * @return False in case the task couldn't be started.
+   */
+  bool start(const char *name, Function function, void *argument);
+
+  /**
+   * Stop the task and wait until it has stopped.
+   */
+  void stop();
+
+  /**
+   * Check whether the task is running.
+   */
+  bool is_running() const { return this->is_running_.load(); }
+
+private:
+  // The function of the task.
+  Function function_{nullptr};
+  // The argument of the function.
+  void *argument_{nullptr};
+  // True as long as the task should run.
+  std::atomic<bool> is_running_{false};
+#if defined(ESP_PLATFORM)
+  // True once the task has stopped.
+  std::atomic<bool> is_stopped_{true};
+#elif defined(OMNIK_RX_TASK_THREAD)
+  // The thread of the task.
+  std::thread thread_;
+#endif
+
+  /**
+   * Call the function until the task is stopped.
+   */
+  void run();
+};
+
+} // namespace omnik_base
+} // namespace esphome
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// This file doesn't depend on ESPHome, so that it can also be used by the
+// host tools.
+
+namespace esphome {
+namespace omnik_base {
+
+/**
+ * A fixed size lock free queue with a single producer and a single consumer.
+ *
+ * Only the producer writes the tail and only the consumer writes the head, so
+ * the producer and the consumer can run concurrently without a lock. The
+ * entries are filled and emptied in place, so that large entries aren't
+ * copied.
+ *
+ * The producer:
+ *   T *entry = queue.get_free();
+ *   if (entry != nullptr) { fill *entry; queue.push(); }
+ *
+ * The consumer:
+ *   T *entry = queue.get_front();
+ *   if (entry != nullptr) { use *entry; queue.pop(); }
+ *
+ * @param T The type of the entries.
+ * @param N The number of entries (a power of 2). One entry is always kept
+ *          free, to distinguish a full queue from an empty queue.
+ */
+template <typename T, size_t N> class SpscQueue {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be a power of 2");
+
+public:
+  /**
+   * Get the free entry that is filled by the producer.
+   *
+   * @return The entry, or nullptr in case the queue is full.
+   */
+  T *get_free() {
+    size_t tail = this->tail_.load(std::memory_order_relaxed);
+    if (((tail + 1) & (N - 1)) ==
+        this->head_.load(std::memory_order_acquire))
+      return nullptr;
+    return &this->entries_[tail];
+  }
+
+  /**
+   * Add the entry that has been filled by the producer to the queue.
+   */
+  void push() {
+    size_t tail = this->tail_.load(std::memory_order_relaxed);
+    this->tail_.store((tail + 1) & (N - 1), std::memory_order_release);
+  }
+
+  /**
+   * Get the oldest entry of the queue, that is used by the consumer.
+   *
+   * @return The entry, or nullptr in case the queue is empty.
+   */
+  T *get_front() {
+    size_t head = this->head_.load(std::memory_order_relaxed);
+    if (head == this->tail_.load(std::memory_order_acquire))
+      return nullptr;
+    return &this->entries_[head];
+  }
+
+  /**
+   * Remove the oldest entry, after it has been used by the consumer.
+   */
+  void pop() {
+    size_t head = this->head_.load(std::memory_order_relaxed);
+    this->head_.store((head + 1) & (N - 1), std::memory_order_release);
+  }
+
+  /**
+   * Check whether the queue is empty (only exact for the consumer).
+   */
+  bool is_empty() const {
+    return this->head_.load(std::memory_order_acquire) ==
+           this->tail_.load(std::memory_order_acquire);
+  }
+
+private:
+  // The entries.
+  T entries_[N];
+  // The position of the oldest entry (written by the consumer).
+  std::atomic<size_t> head_{0};
+  // The position of the free entry (written by the producer).
+  std::atomic<size_t> tail_{0};
+};
+
+} // namespace omnik_base
+} // namespace esphome
@@ -0,0 +1,40 @@
+#include "omnik_text.h"
+
+#include <cctype>
+
+namespace esphome {
+namespace omnik_base {
+
+// The hexadecimal digits.
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+/**
+ * @see the header file.
+ */
+void to_hex(uint8_t byte, char text[]) {
+  text[0] = HEX_DIGITS[byte >> 4];
+  text[1] = HEX_DIGITS[byte & 0x0F];
+  text[2] = '\0';
+}
+
+/**
+ * @see the header file.
+ */
+void to_string(const uint8_t bytes[], size_t size, char text[]) {
+  size_t length = 0;
+  for (size_t i = 0; i < size; i++) {
+    char character = bytes[i];
+    if (character == '\0' ||
+        (length == 0 && std::isspace((unsigned char) character))) {
+      continue;
+    }
+    text[length++] = character;
+  }
+  while (length > 0 && std::isspace((unsigned char) text[length - 1])) {
+    length--;
+  }
+  text[length] = '\0';
+}
+
+} // namespace omnik_base
+} // namespace esphome
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// This file doesn't depend on ESPHome, so that it can also be used by the
+// host tools.
+
+namespace esphome {
+namespace omnik_base {
+
+// The size of the text of one byte in hexadecimal (with the NUL).
+static const size_t HEX_BYTE_SIZE = 3;
+
+/**
+ * Convert a byte to a hexadecimal text without allocating memory.
+ *
+ * @param byte The byte.
+ * @param text The text (at least HEX_BYTE_SIZE characters).
+ */
+void to_hex(uint8_t byte, char text[]);
+
+/**
+ * Convert the data bytes to an ASCII string without allocating memory. The
+ * NUL characters are skipped and the spaces are trimmed.
+ *
+ * @param bytes The data bytes.
+ * @param size The number of data bytes.
+ * @param text The string (at least size + 1 characters, may be bytes).
+ */
+void to_string(const uint8_t bytes[], size_t size, char text[]);
+
+/**
+ * Read data bytes and convert them to an ASCII string without allocating
+ * memory.
+ *
+ * This is a template on the reader, like the message handlers that use it.
+ *
+ * @param reader The reader of the data bytes.
+ * @param size The number of data bytes.
+ * @param text The string (at least size + 1 characters).
+ */
+template <typename Reader>
+void read_string(Reader &reader, size_t size, char text[]) {
+  // The bytes are converted in place, the text is never longer.
+  uint8_t *bytes = reinterpret_cast<uint8_t *>(text);
+  for (size_t i = 0; i < size; i++) {
+    bytes[i] = reader.get_uint8();
+  }
+  to_string(bytes, size, text);
+}
+
+/**
+ * Process a message with one status byte: the byte is published as a
+ * hexadecimal text.
+ *
+ * The message handlers are templates on the reader and on the text state, so
+ * that the firmware (with a text sensor) and the host tools run the same
+ * handlers. A text state has a member function publish(const char *state),
+ * which only publishes a state that has changed.
+ *
+ * @param reader The reader of the data of the message.
+ * @param text_state The text state of the status.
+ */
+template <typename Reader, typename TextState>
+void process_status_message(Reader &reader, TextState &&text_state) {
+  char text[HEX_BYTE_SIZE];
+  to_hex(reader.get_uint8(), text);
+  text_state.publish(text);
+}
+
+/**
+ * Process a message with one string, e.g. a serial number or an IP address.
+ *
+ * @tparam Size The number of data bytes of the string.
+ * @param reader The reader of the data of the message.
+ * @param text_state The text state of the string.
+ */
+template <size_t Size, typename Reader, typename TextState>
+void process_string_message(Reader &reader, TextState &&text_state) {
+  char text[Size + 1];
+  read_string(reader, Size, text);
+  text_state.publish(text);
+}
+
+} // namespace omnik_base
+} // namespace esphome
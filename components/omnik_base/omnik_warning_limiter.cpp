@@ -0,0 +1,41 @@
+#include "omnik_warning_limiter.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace omnik_base {
+
+// The names of the warning classes (in the order of WarningClass).
+static const char *const WARNING_CLASS_NAMES[] = {
+    "checksum errors",
+    "unknown messages",
+};
+
+/**
+ * @see the header file.
+ */
+bool WarningLimiter::allow(WarningClass warning_class) {
+  if (this->counts_[warning_class]++ == 0) {
+    return true;
+  }
+  this->nr_of_suppressed_[warning_class]++;
+  return false;
+}
+
+/**
+ * @see the header file.
+ */
+void WarningLimiter::log_summary(const char *const tag, uint32_t now) {
+  unsigned seconds = (now - this->summary_time_) / 1000;
+  for (uint8_t i = 0; i < NR_OF_WARNING_CLASSES; i++) {
+    if (this->nr_of_suppressed_[i] > 0) {
+      ESP_LOGW(tag, "%u %s in last %u s", (unsigned) this->counts_[i],
+               WARNING_CLASS_NAMES[i], seconds);
+    }
+    this->counts_[i] = 0;
+    this->nr_of_suppressed_[i] = 0;
+  }
+  this->summary_time_ = now;
+}
+
+} // namespace omnik_base
+} // namespace esphome
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace omnik_base {
+
+/**
+ * The classes of the protocol warnings.
+ */
+enum WarningClass : uint8_t {
+  WARNING_CHECKSUM_ERROR,
+  WARNING_UNKNOWN_MESSAGE,
+};
+
+// The number of warning classes.
+static const uint8_t NR_OF_WARNING_CLASSES = WARNING_UNKNOWN_MESSAGE + 1;
+
+/**
+ * Limits the protocol warnings that are logged, so that a noisy line can't
+ * flood the logger (which blocks the loop while it writes to the UART).
+ *
+ * Only the first warning of a class in a summary interval is logged. The other
+ * warnings are counted, and the counts are logged once per summary interval.
+ */
+class WarningLimiter {
+public:
+  // The interval at which the summary is logged (in milliseconds).
+  static const uint32_t SUMMARY_INTERVAL = 60000;
+
+  /**
+   * Count a warning and check whether it may be logged.
+   *
+   * @param warning_class The class of the warning.
+   * @return True in case the warning may be logged, False in case it is
+   *         suppressed.
+   */
+  bool allow(WarningClass warning_class);
+
+  /**
+   * Count a warning that isn't logged anyway, e.g. a repeat that has already
+   * been logged before.
+   *
+   * @param warning_class The class of the warning.
+   */
+  void suppress(WarningClass warning_class) {
+    this->counts_[warning_class]++;
+    this->nr_of_suppressed_[warning_class]++;
+  }
+
+  /**
+   * Log the number of warnings of each class that has suppressed warnings,
+   * and start a new summary interval.
+   *
+   * @param tag The tag to use for the log messages.
+   * @param now The current time (in milliseconds).
+   */
+  void log_summary(const char *const tag, uint32_t now);
+
+private:
+  // The start of the summary interval (in milliseconds).
+  uint32_t summary_time_{0};
+  // The number of warnings of each class in the summary interval.
+  uint32_t counts_[NR_OF_WARNING_CLASSES]{};
+  // The number of suppressed warnings of each class in the summary interval.
+  uint32_t nr_of_suppressed_[NR_OF_WARNING_CLASSES]{};
+};
+
+} // namespace omnik_base
+} // namespace esphome
@@ -0,0 +1,41 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.const import (
+    CONF_ID,
+)
+from esphome.components import (
+    uart,
+)
+from ..omnik_base import (
+    to_code_frame_gap,
+    to_code_rx_task,
+    validate_rx_task,
+    OmnikBus,
+    FRAME_GAP_SCHEMA,
+    RX_TASK_SCHEMA,
+)
+
+AUTO_LOAD = [
+    "omnik_base",
+]
+MULTI_CONF = True
+
+CONFIG_SCHEMA = cv.All(
+    cv.COMPONENT_SCHEMA
+    .extend(uart.UART_DEVICE_SCHEMA)
+    .extend(RX_TASK_SCHEMA)
+    .extend(FRAME_GAP_SCHEMA)
+    .extend({
+        cv.GenerateID(): cv.declare_id(OmnikBus),
+    }),
+    validate_rx_task,
+)
+
+async def to_code(config):
+    comp = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(comp, config)
+    await uart.register_uart_device(comp, config)
+    await to_code_frame_gap(comp, config)
+    await to_code_rx_task(comp, config)
+
+# vim:sw=4:
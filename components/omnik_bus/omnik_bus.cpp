@@ -0,0 +1,42 @@
+#include "omnik_bus.h"
+
+namespace esphome {
+namespace omnik_bus {
+
+// Tag that is used for log messages.
+static const char *const TAG = "omnik_bus";
+
+/**
+ * @see the header file.
+ */
+void OmnikBus::dump_config() {
+  ESP_LOGCONFIG(TAG, "OmnikBus:");
+  omnik_base::dump_config(TAG, "  ", this);
+  ESP_LOGCONFIG(TAG, "  Devices: %u", (unsigned) this->devices_.size());
+}
+
+/**
+ * @see the header file.
+ */
+bool OmnikBus::route_omnik_message(uint16_t sender_address,
+                                   uint8_t control_code, uint8_t function_code,
+                                   omnik_base::BigEndianReader &buffer) {
+  bool accepted = false;
+  for (omnik_base::OmnikBase *device : this->devices_) {
+    buffer.set_position(0);
+    if (device->route_omnik_message(sender_address, control_code,
+                                    function_code, buffer)) {
+      accepted = true;
+    }
+  }
+  if (!accepted) {
+    ESP_LOGV(TAG,
+             "No device for: sender_address=0x%04X, control_code=0x%02x, "
+             "function_code=0x%02x",
+             sender_address, control_code, function_code);
+  }
+  return accepted;
+}
+
+} // namespace omnik_bus
+} // namespace esphome
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "esphome/components/omnik_base/omnik_base.h"
+
+#include <vector>
+
+namespace esphome {
+namespace omnik_bus {
+
+/**
+ * This class is responsible for receiving the messages of several Omnik
+ * devices that share one RS485 bus. The messages are received with one UART
+ * and one parser, and are then routed to the devices that are attached to the
+ * bus. Each device decides, based on the sender address or the serial number,
+ * whether a message is meant for it.
+ */
+class OmnikBus : public omnik_base::OmnikBase {
+public:
+  /**
+   * Log the current configuration.
+   */
+  void dump_config() override;
+
+  /**
+   * Attach a device to this bus.
+   *
+   * @param device The device that receives the messages from this bus.
+   */
+  void register_device(omnik_base::OmnikBase *device) {
+    this->devices_.push_back(device);
+  }
+
+  /**
+   * Route a received Omnik message to the attached devices.
+   *
+   * See omnik_base::OmnikBase for a full description.
+   */
+  bool route_omnik_message(uint16_t sender_address, uint8_t control_code,
+                           uint8_t function_code,
+                           omnik_base::BigEndianReader &buffer) override;
+
+protected:
+  /**
+   * process an Omnik message.
+   *
+   * The bus itself doesn't process any messages.
+   */
+  void process_omnik_message(uint8_t control_code, uint8_t function_code,
+                             omnik_base::BigEndianReader &buffer) override {}
+
+private:
+  // The devices that are attached to this bus.
+  std::vector<omnik_base::OmnikBase *> devices_;
+};
+
+} // namespace omnik_bus
+} // namespace esphome
@@ -0,0 +1,44 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.const import (
+    CONF_BAUD_RATE,
+    CONF_ID,
+    CONF_PATH,
+    CONF_PORT,
+    PLATFORM_HOST,
+)
+from esphome.components import (
+    uart,
+)
+
+MULTI_CONF = True
+
+omnik_host_uart_ns = cg.esphome_ns.namespace("omnik_host_uart")
+OmnikHostUart = omnik_host_uart_ns.class_(
+    "OmnikHostUart",
+    uart.UARTComponent,
+    cg.Component,
+)
+
+CONFIG_SCHEMA = cv.All(
+    cv.COMPONENT_SCHEMA
+    .extend({
+        cv.GenerateID(): cv.declare_id(OmnikHostUart),
+        cv.Optional(CONF_PATH): cv.string_strict,
+        cv.Optional(CONF_PORT): cv.port,
+        cv.Optional(CONF_BAUD_RATE, default=9600): cv.int_range(min=1),
+    }),
+    cv.has_exactly_one_key(CONF_PATH, CONF_PORT),
+    cv.only_on(PLATFORM_HOST),
+)
+
+async def to_code(config):
+    comp = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(comp, config)
+    cg.add(comp.set_baud_rate(config[CONF_BAUD_RATE]))
+    if CONF_PATH in config:
+        cg.add(comp.set_path(config[CONF_PATH]))
+    if CONF_PORT in config:
+        cg.add(comp.set_port(config[CONF_PORT]))
+
+# vim:sw=4:
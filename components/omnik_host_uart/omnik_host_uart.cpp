@@ -0,0 +1,219 @@
+#ifdef USE_HOST
+
+#include "omnik_host_uart.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace esphome {
+namespace omnik_host_uart {
+
+// Tag that is used for log messages.
+static const char *const TAG = "omnik_host_uart";
+
+/**
+ * @see the header file.
+ */
+void OmnikHostUart::setup() {
+  uint32_t bits_per_byte = 1 + this->get_data_bits() + this->get_stop_bits();
+  if (this->get_parity() != uart::UART_CONFIG_PARITY_NONE) {
+    bits_per_byte++;
+  }
+  this->byte_time_ =
+      (uint64_t) bits_per_byte * 1000000 / std::max<uint32_t>(
+                                                this->get_baud_rate(), 1);
+  this->receive_time_ = micros();
+
+  if (!(this->port_ > 0 ? this->open_socket() : this->open_pty())) {
+    this->mark_failed();
+  }
+}
+
+/**
+ * @see the header file.
+ */
+bool OmnikHostUart::open_pty() {
+  this->fd_ = posix_openpt(O_RDWR | O_NOCTTY);
+  if (this->fd_ < 0 || grantpt(this->fd_) != 0 || unlockpt(this->fd_) != 0) {
+    ESP_LOGE(TAG, "Could not open a pseudo-terminal: %s", strerror(errno));
+    return false;
+  }
+  const char *slave_path = ptsname(this->fd_);
+  this->slave_fd_ = open(slave_path, O_RDWR | O_NOCTTY);
+  if (this->slave_fd_ < 0) {
+    ESP_LOGE(TAG, "Could not open %s: %s", slave_path, strerror(errno));
+    return false;
+  }
+
+  // The bytes are passed as they are, without any line discipline.
+  struct termios attributes;
+  tcgetattr(this->slave_fd_, &attributes);
+  cfmakeraw(&attributes);
+  tcsetattr(this->slave_fd_, TCSANOW, &attributes);
+  fcntl(this->fd_, F_SETFL, fcntl(this->fd_, F_GETFL) | O_NONBLOCK);
+
+  unlink(this->path_.c_str());
+  if (symlink(slave_path, this->path_.c_str()) != 0) {
+    ESP_LOGE(TAG, "Could not link %s to %s: %s", this->path_.c_str(),
+             slave_path, strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @see the header file.
+ */
+bool OmnikHostUart::open_socket() {
+  this->listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  if (this->listen_fd_ < 0) {
+    ESP_LOGE(TAG, "Could not create a socket: %s", strerror(errno));
+    return false;
+  }
+  int enable = 1;
+  setsockopt(this->listen_fd_, SOL_SOCKET, SO_REUSEADDR, &enable,
+             sizeof(enable));
+  fcntl(this->listen_fd_, F_SETFL,
+        fcntl(this->listen_fd_, F_GETFL) | O_NONBLOCK);
+
+  struct sockaddr_in address {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(this->port_);
+  if (bind(this->listen_fd_, (struct sockaddr *) &address, sizeof(address)) !=
+          0 ||
+      listen(this->listen_fd_, 1) != 0) {
+    ESP_LOGE(TAG, "Could not listen on port %u: %s", this->port_,
+             strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @see the header file.
+ */
+void OmnikHostUart::dump_config() {
+  ESP_LOGCONFIG(TAG, "OmnikHostUart:");
+  if (this->port_ > 0) {
+    ESP_LOGCONFIG(TAG, "  Port: %u", this->port_);
+  } else {
+    ESP_LOGCONFIG(TAG, "  Path: %s", this->path_.c_str());
+  }
+  ESP_LOGCONFIG(TAG, "  Baud Rate: %u", (unsigned) this->get_baud_rate());
+  ESP_LOGCONFIG(TAG, "  Byte Time: %u us", (unsigned) this->byte_time_);
+}
+
+/**
+ * @see the header file.
+ */
+void OmnikHostUart::receive() {
+  // Accept the next client once the previous one has disconnected.
+  if (this->fd_ < 0 && this->listen_fd_ >= 0) {
+    this->fd_ = accept(this->listen_fd_, nullptr, nullptr);
+    if (this->fd_ < 0) {
+      return;
+    }
+    fcntl(this->fd_, F_SETFL, fcntl(this->fd_, F_GETFL) | O_NONBLOCK);
+    ESP_LOGI(TAG, "Client connected");
+    this->receive_time_ = micros();
+  }
+  if (this->fd_ < 0) {
+    return;
+  }
+
+  // The number of bytes that a UART would have received since the last call.
+  const uint32_t now = micros();
+  size_t nr_of_bytes = (now - this->receive_time_) / this->byte_time_;
+  if (this->head_ > 0) {
+    memmove(this->buffer_, this->buffer_ + this->head_, this->size_);
+    this->head_ = 0;
+  }
+  nr_of_bytes = std::min(nr_of_bytes, BUFFER_SIZE - this->size_);
+  if (nr_of_bytes == 0) {
+    return;
+  }
+
+  ssize_t nr_of_read_bytes =
+      read(this->fd_, this->buffer_ + this->size_, nr_of_bytes);
+  if (nr_of_read_bytes == 0 ||
+      (nr_of_read_bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+    // The client disconnected (a pseudo-terminal never gets here, because
+    // its slave is kept open).
+    if (this->listen_fd_ >= 0) {
+      ESP_LOGI(TAG, "Client disconnected");
+      close(this->fd_);
+      this->fd_ = -1;
+    }
+    return;
+  }
+  if (nr_of_read_bytes < 0) {
+    nr_of_read_bytes = 0;
+  }
+  this->size_ += nr_of_read_bytes;
+
+  // The time doesn't add up while nothing is received, so that the bytes
+  // after a pause aren't passed on in one burst.
+  if ((size_t) nr_of_read_bytes < nr_of_bytes) {
+    this->receive_time_ = now;
+  } else {
+    this->receive_time_ += nr_of_read_bytes * this->byte_time_;
+  }
+}
+
+/**
+ * @see the header file.
+ */
+int OmnikHostUart::available() {
+  this->receive();
+  return this->size_;
+}
+
+/**
+ * @see the header file.
+ */
+bool OmnikHostUart::peek_byte(uint8_t *data) {
+  if (this->available() == 0) {
+    return false;
+  }
+  *data = this->buffer_[this->head_];
+  return true;
+}
+
+/**
+ * @see the header file.
+ */
+bool OmnikHostUart::read_array(uint8_t *data, size_t len) {
+  if ((size_t) this->available() < len) {
+    return false;
+  }
+  memcpy(data, this->buffer_ + this->head_, len);
+  this->head_ += len;
+  this->size_ -= len;
+  return true;
+}
+
+/**
+ * @see the header file.
+ */
+void OmnikHostUart::write_array(const uint8_t *data, size_t len) {
+  if (this->fd_ >= 0 && write(this->fd_, data, len) < 0) {
+    ESP_LOGW(TAG, "Could not write %u bytes: %s", (unsigned) len,
+             strerror(errno));
+  }
+}
+
+} // namespace omnik_host_uart
+} // namespace esphome
+
+#endif // USE_HOST
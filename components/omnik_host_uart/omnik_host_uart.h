@@ -0,0 +1,144 @@
+#pragma once
+
+#include "esphome/components/uart/uart.h"
+#include "esphome/core/component.h"
+
+#include <string>
+
+namespace esphome {
+namespace omnik_host_uart {
+
+/**
+ * This class is responsible for standing in for a UART on the host platform,
+ * so that the Omnik components run as a Linux process that is fed by a replay
+ * of a capture or by a simulator.
+ *
+ * The bytes are read from a pseudo-terminal or from a TCP connection:
+ * * path: A pseudo-terminal is opened and its slave is linked at the path,
+ *   e.g. cat capture.bin > /tmp/omnik-inverter
+ * * port: The bytes are read from the client that connects to the port on the
+ *   local host, e.g. nc localhost 8898 < capture.bin
+ *
+ * The bytes are passed on no faster than the baud rate, so that the timing of
+ * the frame assembler is the same as with a real UART.
+ */
+class OmnikHostUart : public uart::UARTComponent, public Component {
+public:
+  OmnikHostUart() {
+    this->set_rx_buffer_size(BUFFER_SIZE);
+    this->set_data_bits(8);
+    this->set_stop_bits(1);
+    this->set_parity(uart::UART_CONFIG_PARITY_NONE);
+  }
+
+  /**
+   * Read the bytes from a pseudo-terminal of which the slave is linked at
+   * this path.
+   */
+  void set_path(const std::string &path) { this->path_ = path; }
+
+  /**
+   * Read the bytes from a client that connects to this TCP port.
+   */
+  void set_port(uint16_t port) { this->port_ = port; }
+
+  /**
+   * Open the pseudo-terminal or the listening socket.
+   */
+  void setup() override;
+
+  /**
+   * Log the current configuration.
+   */
+  void dump_config() override;
+
+  /**
+   * The UART has to be set up before the devices that use it.
+   */
+  float get_setup_priority() const override { return setup_priority::BUS; }
+
+  /**
+   * Write the bytes to the pseudo-terminal or the client (they are dropped in
+   * case no client is connected).
+   */
+  void write_array(const uint8_t *data, size_t len) override;
+
+  /**
+   * Get the next byte without removing it.
+   */
+  bool peek_byte(uint8_t *data) override;
+
+  /**
+   * Read a number of bytes.
+   *
+   * @return False in case less bytes are available.
+   */
+  bool read_array(uint8_t *data, size_t len) override;
+
+  /**
+   * Get the number of bytes that are available.
+   */
+  int available() override;
+
+  /**
+   * Nothing is buffered for writing.
+   */
+  void flush() override {}
+
+protected:
+  /**
+   * A host UART never conflicts with the logger.
+   */
+  void check_logger_conflict() override {}
+
+private:
+  // The size of the receive buffer.
+  static const size_t BUFFER_SIZE = 256;
+
+  // The path at which the slave of the pseudo-terminal is linked.
+  std::string path_;
+  // The TCP port to which the client connects (0 in case a pseudo-terminal
+  // is used).
+  uint16_t port_{0};
+  // The file descriptor from which the bytes are read (the master of the
+  // pseudo-terminal or the connected client, -1 in case there is none).
+  int fd_{-1};
+  // The slave of the pseudo-terminal. It is kept open, so that the master
+  // doesn't fail while no writer has the slave open.
+  int slave_fd_{-1};
+  // The listening socket.
+  int listen_fd_{-1};
+  // The time it takes to receive one byte at the baud rate (in
+  // microseconds).
+  uint32_t byte_time_{0};
+  // The time up to which the bytes have been passed on (in microseconds).
+  uint32_t receive_time_{0};
+  // The bytes that have been received but not read.
+  uint8_t buffer_[BUFFER_SIZE];
+  // The position of the first byte in the buffer.
+  size_t head_{0};
+  // The number of bytes in the buffer.
+  size_t size_{0};
+
+  /**
+   * Open the pseudo-terminal and link its slave at the path.
+   *
+   * @return False in case it failed.
+   */
+  bool open_pty();
+
+  /**
+   * Open the listening socket.
+   *
+   * @return False in case it failed.
+   */
+  bool open_socket();
+
+  /**
+   * Receive the bytes that have arrived at the baud rate since the last call.
+   */
+  void receive();
+};
+
+} // namespace omnik_host_uart
+} // namespace esphome
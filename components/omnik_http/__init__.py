@@ -0,0 +1,64 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.const import (
+    CONF_ID,
+)
+from esphome.components import (
+    web_server_base,
+)
+from esphome.components.web_server_base import (
+    CONF_WEB_SERVER_BASE_ID,
+)
+from ..omnik_base import (
+    OmnikBase,
+    OmnikBus,
+)
+from ..omnik_inverter import (
+    OmnikInverter,
+)
+
+AUTO_LOAD = [
+    "web_server_base",
+]
+DEPENDENCIES = [
+    "network",
+]
+
+omnik_http_ns = cg.esphome_ns.namespace("omnik_http")
+OmnikHttp = omnik_http_ns.class_(
+    "OmnikHttp",
+    cg.Component,
+)
+
+CONF_BUSES = "buses"
+CONF_INVERTERS = "inverters"
+CONF_LOGGERS = "loggers"
+
+CONFIG_SCHEMA = (
+    cv.COMPONENT_SCHEMA
+    .extend({
+        cv.GenerateID(): cv.declare_id(OmnikHttp),
+        cv.GenerateID(CONF_WEB_SERVER_BASE_ID):
+            cv.use_id(web_server_base.WebServerBase),
+        cv.Optional(CONF_INVERTERS, default=[]):
+            cv.ensure_list(cv.use_id(OmnikInverter)),
+        cv.Optional(CONF_LOGGERS, default=[]):
+            cv.ensure_list(cv.use_id(OmnikBase)),
+        cv.Optional(CONF_BUSES, default=[]):
+            cv.ensure_list(cv.use_id(OmnikBus)),
+    })
+)
+
+async def to_code(config):
+    base = await cg.get_variable(config[CONF_WEB_SERVER_BASE_ID])
+    comp = cg.new_Pvariable(config[CONF_ID], base)
+    await cg.register_component(comp, config)
+
+    for inverter_id in config[CONF_INVERTERS]:
+        inverter = await cg.get_variable(inverter_id)
+        cg.add(comp.add_inverter(inverter, inverter_id.id))
+    for device_id in config[CONF_LOGGERS] + config[CONF_BUSES]:
+        device = await cg.get_variable(device_id)
+        cg.add(comp.add_device(device, device_id.id))
+
+# vim:sw=4:
@@ -0,0 +1,67 @@
+#include "omnik_history_writer.h"
+#include "esphome/core/hal.h"
+
+namespace esphome {
+namespace omnik_http {
+
+using omnik_base::DeltaHistory;
+using omnik_inverter::RealtimeField;
+
+/**
+ * @see the header file.
+ */
+HistoryWriter::HistoryWriter(const omnik_inverter::OmnikInverter *inverter,
+                             uint32_t since)
+    : inverter_(inverter), reader_(inverter->get_history()), since_(since) {}
+
+/**
+ * @see the header file.
+ */
+int HistoryWriter::render_line() {
+  const std::vector<RealtimeField> &fields =
+      this->inverter_->get_history_fields();
+  int length = 0;
+
+  switch (this->nr_of_lines_++) {
+  case 0:
+    return snprintf(this->line_, sizeof(this->line_), "# uptime=%u\n",
+                    (unsigned) (millis() / 1000));
+
+  case 1:
+    append(length, "timestamp");
+    for (RealtimeField field : fields) {
+      append(length, ",%s", omnik_inverter::get_realtime_field_name(field));
+    }
+    break;
+
+  default: {
+    uint32_t timestamp;
+    int32_t values[DeltaHistory::MAX_VALUES];
+    do {
+      if (!this->reader_.next(timestamp, values)) {
+        return -1;
+      }
+    } while (timestamp <= this->since_);
+
+    append(length, "%u", (unsigned) timestamp);
+    for (size_t i = 0; i < fields.size() && i < DeltaHistory::MAX_VALUES;
+         i++) {
+      // The bitmap is the only value that uses all 32 bits.
+      int64_t value =
+          fields[i] == omnik_inverter::REALTIME_FIELD_ERROR_MESSAGE_BINARY_INDEX
+              ? (int64_t) (uint32_t) values[i]
+              : values[i];
+      append(length, ",");
+      append_value(length, value,
+                   omnik_inverter::get_realtime_field_decimals(fields[i]));
+    }
+    break;
+  }
+  }
+
+  append(length, "\n");
+  return length;
+}
+
+} // namespace omnik_http
+} // namespace esphome
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "esphome/components/omnik_inverter/omnik_inverter.h"
+#include "omnik_line_writer.h"
+
+namespace esphome {
+namespace omnik_http {
+
+/**
+ * This class is responsible for rendering the history of an inverter as CSV,
+ * one sample at a time.
+ *
+ * The first line contains the current time, the second line the names of the
+ * columns. The timestamps are in seconds since boot.
+ */
+class HistoryWriter : public LineWriter {
+public:
+  /**
+   * Create a writer for the history of an inverter.
+   *
+   * @param inverter The inverter.
+   * @param since Only the samples after this timestamp are rendered.
+   */
+  HistoryWriter(const omnik_inverter::OmnikInverter *inverter, uint32_t since);
+
+protected:
+  /**
+   * Render the next line in line_.
+   */
+  int render_line() override;
+
+private:
+  // The inverter.
+  const omnik_inverter::OmnikInverter *inverter_;
+  // The reader of the history.
+  omnik_base::DeltaHistory::Reader reader_;
+  // Only the samples after this timestamp are rendered.
+  uint32_t since_;
+  // The number of lines that have been rendered.
+  uint32_t nr_of_lines_{0};
+};
+
+} // namespace omnik_http
+} // namespace esphome
@@ -0,0 +1,137 @@
+#include "omnik_http.h"
+#include "omnik_history_writer.h"
+#include "omnik_metrics.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#ifndef USE_ARDUINO
+#include <esp_http_server.h>
+#endif
+
+namespace esphome {
+namespace omnik_http {
+
+// Tag that is used for log messages.
+static const char *const TAG = "omnik_http";
+// The content type of the history.
+static const char *const HISTORY_CONTENT_TYPE = "text/csv";
+// The content type of the Prometheus text format.
+static const char *const METRICS_CONTENT_TYPE =
+    "text/plain; version=0.0.4; charset=utf-8";
+#ifndef USE_ARDUINO
+// The size of the chunks of a response of the ESP-IDF web server.
+static const size_t CHUNK_SIZE = 1024;
+#endif
+
+/**
+ * @see the header file.
+ */
+void OmnikHttp::setup() {
+  this->base_->init();
+  this->base_->add_handler(this);
+}
+
+/**
+ * @see the header file.
+ */
+void OmnikHttp::dump_config() {
+  ESP_LOGCONFIG(TAG, "OmnikHttp:");
+  ESP_LOGCONFIG(TAG, "  Metrics: /metrics");
+  ESP_LOGCONFIG(TAG, "  History: /history");
+  for (const Device &device : this->devices_) {
+    ESP_LOGCONFIG(TAG, "  Device: %s%s", device.name,
+                  device.inverter != nullptr ? " (inverter)" : "");
+  }
+}
+
+/**
+ * @see the header file.
+ */
+bool OmnikHttp::canHandle(AsyncWebServerRequest *request) const {
+  return request->method() == HTTP_GET &&
+         (request->url() == "/metrics" || request->url() == "/history");
+}
+
+/**
+ * @see the header file.
+ */
+void OmnikHttp::handleRequest(AsyncWebServerRequest *request) {
+  if (request->url() == "/history") {
+    handle_history(request);
+  } else {
+    handle_metrics(request);
+  }
+}
+
+/**
+ * @see the header file.
+ */
+void OmnikHttp::handle_metrics(AsyncWebServerRequest *request) {
+  send(request, METRICS_CONTENT_TYPE,
+       std::make_shared<MetricsWriter>(this->devices_));
+}
+
+/**
+ * @see the header file.
+ */
+void OmnikHttp::handle_history(AsyncWebServerRequest *request) {
+  const omnik_inverter::OmnikInverter *inverter = nullptr;
+  for (const Device &device : this->devices_) {
+    if (device.inverter == nullptr ||
+        device.inverter->get_history().get_size() == 0) {
+      continue;
+    }
+    if (!request->hasParam("device") ||
+        strcmp(request->getParam("device")->value().c_str(), device.name) ==
+            0) {
+      inverter = device.inverter;
+      break;
+    }
+  }
+  if (inverter == nullptr) {
+    request->send(404, "text/plain", "No history");
+    return;
+  }
+
+  uint32_t since = 0;
+  if (request->hasParam("since")) {
+    since = strtoul(request->getParam("since")->value().c_str(), nullptr, 10);
+  }
+  send(request, HISTORY_CONTENT_TYPE,
+       std::make_shared<HistoryWriter>(inverter, since));
+}
+
+/**
+ * @see the header file.
+ */
+void OmnikHttp::send(AsyncWebServerRequest *request, const char *content_type,
+                     std::shared_ptr<LineWriter> writer) {
+#ifdef USE_ARDUINO
+  // The response is rendered in chunks while it is sent.
+  AsyncWebServerResponse *response = request->beginChunkedResponse(
+      content_type,
+      [writer](uint8_t *buffer, size_t max_length, size_t index) -> size_t {
+        return writer->fill(buffer, max_length);
+      });
+  request->send(response);
+#else
+  // The ESP-IDF web server has no chunked responses, so the chunks are sent
+  // with the HTTP server of ESP-IDF, which the request wraps.
+  httpd_req_t *req = *request;
+  httpd_resp_set_type(req, content_type);
+  uint8_t buffer[CHUNK_SIZE];
+  size_t length;
+  while ((length = writer->fill(buffer, sizeof(buffer))) > 0) {
+    if (httpd_resp_send_chunk(req, reinterpret_cast<const char *>(buffer),
+                              length) != ESP_OK) {
+      ESP_LOGW(TAG, "Response aborted");
+      return;
+    }
+  }
+  httpd_resp_send_chunk(req, nullptr, 0);
+#endif
+}
+
+} // namespace omnik_http
+} // namespace esphome
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "esphome/components/omnik_base/omnik_base.h"
+#include "esphome/components/omnik_inverter/omnik_inverter.h"
+#include "esphome/components/web_server_base/web_server_base.h"
+#include "esphome/core/component.h"
+#include "omnik_line_writer.h"
+
+#include <memory>
+#include <vector>
+
+namespace esphome {
+namespace omnik_http {
+
+/**
+ * A device of which the values are served.
+ */
+struct Device {
+  // The device.
+  omnik_base::OmnikBase *base;
+  // The device as an inverter (nullptr in case it isn't an inverter).
+  omnik_inverter::OmnikInverter *inverter;
+  // The name of the device (used as the label value).
+  const char *name;
+};
+
+/**
+ * This class is responsible for serving the decoded values of the Omnik
+ * devices over HTTP.
+ *
+ * * /metrics The values in the Prometheus text format.
+ * * /history[?device=<name>][&since=<timestamp>] The history of an inverter
+ *   as CSV.
+ *
+ * The responses are rendered line by line while they are sent, so that a
+ * request never builds the complete page in memory.
+ */
+class OmnikHttp : public AsyncWebHandler, public Component {
+public:
+  OmnikHttp(web_server_base::WebServerBase *base) : base_(base) {}
+
+  /**
+   * Serve the values of an inverter.
+   *
+   * @param inverter The inverter.
+   * @param name The name of the inverter.
+   */
+  void add_inverter(omnik_inverter::OmnikInverter *inverter,
+                    const char *name) {
+    this->devices_.push_back({inverter, inverter, name});
+  }
+
+  /**
+   * Serve the link statistics of a device.
+   *
+   * @param device The device (logger or bus).
+   * @param name The name of the device.
+   */
+  void add_device(omnik_base::OmnikBase *device, const char *name) {
+    this->devices_.push_back({device, nullptr, name});
+  }
+
+  /**
+   * Register the handler at the web server.
+   */
+  void setup() override;
+
+  /**
+   * Log the current configuration.
+   */
+  void dump_config() override;
+
+  /**
+   * The web server has to be set up first.
+   */
+  float get_setup_priority() const override {
+    return setup_priority::WIFI - 1.0f;
+  }
+
+  /**
+   * Check whether the request is handled by this handler.
+   */
+  bool canHandle(AsyncWebServerRequest *request) const override;
+
+  /**
+   * Handle the request.
+   */
+  void handleRequest(AsyncWebServerRequest *request) override;
+
+private:
+  // The web server.
+  web_server_base::WebServerBase *base_;
+  // The devices of which the values are served.
+  std::vector<Device> devices_;
+
+  /**
+   * Handle a /metrics request.
+   */
+  void handle_metrics(AsyncWebServerRequest *request);
+
+  /**
+   * Handle a /history request.
+   */
+  void handle_history(AsyncWebServerRequest *request);
+
+  /**
+   * Send the lines of a writer as the response, as a chunked response that
+   * is rendered while it is sent.
+   *
+   * @param request The request.
+   * @param content_type The content type of the response.
+   * @param writer The writer of the response.
+   */
+  void send(AsyncWebServerRequest *request, const char *content_type,
+            std::shared_ptr<LineWriter> writer);
+};
+
+} // namespace omnik_http
+} // namespace esphome
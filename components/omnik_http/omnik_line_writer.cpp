@@ -0,0 +1,97 @@
+#include "omnik_line_writer.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace esphome {
+namespace omnik_http {
+
+/**
+ * @see the header file.
+ */
+const char *LineWriter::next_line() {
+  if (!render_next_line()) {
+    return nullptr;
+  }
+  this->line_position_ = this->line_length_;
+  return this->line_;
+}
+
+/**
+ * @see the header file.
+ */
+size_t LineWriter::fill(uint8_t *buffer, size_t max_length) {
+  size_t length = 0;
+  while (length < max_length) {
+    if (this->line_position_ == this->line_length_) {
+      if (!render_next_line()) {
+        break;
+      }
+    }
+    size_t size = std::min(max_length - length,
+                           this->line_length_ - this->line_position_);
+    memcpy(buffer + length, this->line_ + this->line_position_, size);
+    length += size;
+    this->line_position_ += size;
+  }
+  return length;
+}
+
+/**
+ * @see the header file.
+ */
+bool LineWriter::render_next_line() {
+  int length = render_line();
+  if (length < 0) {
+    return false;
+  }
+
+  // A line that didn't fit is truncated, but always ends with a new line.
+  if ((size_t) length >= sizeof(this->line_)) {
+    length = sizeof(this->line_) - 1;
+    this->line_[length - 1] = '\n';
+  }
+  this->line_length_ = length;
+  this->line_position_ = 0;
+  return true;
+}
+
+/**
+ * @see the header file.
+ */
+void LineWriter::append(int &length, const char *format, ...) {
+  if (length < 0 || (size_t) length >= sizeof(this->line_)) {
+    return;
+  }
+  va_list arguments;
+  va_start(arguments, format);
+  length += vsnprintf(this->line_ + length, sizeof(this->line_) - length,
+                      format, arguments);
+  va_end(arguments);
+}
+
+/**
+ * @see the header file.
+ */
+void LineWriter::append_value(int &length, int64_t value, uint8_t decimals) {
+  if (decimals == 0) {
+    append(length, "%" PRId64, value);
+    return;
+  }
+  int64_t divisor = 1;
+  for (uint8_t i = 0; i < decimals; i++) {
+    divisor *= 10;
+  }
+  const char *sign = value < 0 ? "-" : "";
+  if (value < 0) {
+    value = -value;
+  }
+  append(length, "%s%" PRId64 ".%0*" PRId64, sign, value / divisor,
+         (int) decimals, value % divisor);
+}
+
+} // namespace omnik_http
+} // namespace esphome
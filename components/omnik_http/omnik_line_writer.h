@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// This file doesn't depend on ESPHome, so that it can also be used by the
+// host tools.
+
+namespace esphome {
+namespace omnik_http {
+
+/**
+ * The base class of the writers that render a response one line at a time.
+ */
+class LineWriter {
+public:
+  virtual ~LineWriter() = default;
+
+  /**
+   * Render the next line.
+   *
+   * @return The next line (including the new line), or nullptr in case all
+   *         the lines have been rendered.
+   */
+  const char *next_line();
+
+  /**
+   * Fill a buffer with the next part of the response.
+   *
+   * @param buffer The buffer to fill.
+   * @param max_length The size of the buffer.
+   * @return The number of bytes in the buffer, 0 at the end of the response.
+   */
+  size_t fill(uint8_t *buffer, size_t max_length);
+
+protected:
+  // The current line.
+  char line_[512];
+
+  /**
+   * Render the next line in line_.
+   *
+   * @return The length of the line, or a negative value at the end.
+   */
+  virtual int render_line() = 0;
+
+  /**
+   * Append formatted text to line_.
+   *
+   * @param length The length of the line so far, which is updated.
+   * @param format The format (see printf).
+   */
+  void append(int &length, const char *format, ...)
+      __attribute__((format(printf, 3, 4)));
+
+  /**
+   * Append a raw value with a number of decimals to line_.
+   *
+   * @param length The length of the line so far, which is updated.
+   * @param value The raw value.
+   * @param decimals The number of decimals of the raw value.
+   */
+  void append_value(int &length, int64_t value, uint8_t decimals);
+
+private:
+  // The length of the current line.
+  size_t line_length_{0};
+  // The number of bytes of the current line that have been written.
+  size_t line_position_{0};
+
+  /**
+   * Render the next line.
+   *
+   * @return True in case a line was rendered, False at the end.
+   */
+  bool render_next_line();
+};
+
+} // namespace omnik_http
+} // namespace esphome
@@ -0,0 +1,266 @@
+#include "omnik_metrics.h"
+
+
+namespace esphome {
+namespace omnik_http {
+
+using omnik_base::LinkStatistics;
+using omnik_inverter::RealtimeData;
+using omnik_inverter::RealtimeField;
+
+/**
+ * A metric of a 0x11/0x90 message.
+ */
+struct RealtimeMetric {
+  // The name of the metric (without the prefix).
+  const char *name;
+  // The extra label of the metric (can be nullptr).
+  const char *label;
+  // The description of the metric.
+  const char *help;
+  // The field of RealtimeData (the number of decimals of the raw value is
+  // the one of the field).
+  RealtimeField field;
+};
+
+/**
+ * A metric of the link statistics.
+ */
+struct LinkMetric {
+  // The name of the metric (without the prefix).
+  const char *name;
+  // The description of the metric.
+  const char *help;
+  // Get the value of the metric.
+  uint32_t (*value)(const LinkStatistics &statistics);
+};
+
+// The prefix of all the metrics.
+#define PREFIX "omnik_"
+
+// The metrics of the 0x11/0x90 message. The metrics with the same name have
+// to be next to each other.
+static const RealtimeMetric REALTIME_METRICS[] = {
+    {"temperature_celsius", nullptr, "Temperature of the inverter.",
+     omnik_inverter::REALTIME_FIELD_TEMPERATURE},
+    {"pv_voltage_volts", "pv=\"1\"", "Voltage of the PV string.",
+     omnik_inverter::REALTIME_FIELD_PV1_VOLTAGE},
+    {"pv_voltage_volts", "pv=\"2\"", nullptr,
+     omnik_inverter::REALTIME_FIELD_PV2_VOLTAGE},
+    {"pv_voltage_volts", "pv=\"3\"", nullptr,
+     omnik_inverter::REALTIME_FIELD_PV3_VOLTAGE},
+    {"pv_current_amperes", "pv=\"1\"", "Current of the PV string.",
+     omnik_inverter::REALTIME_FIELD_PV1_CURRENT},
+    {"pv_current_amperes", "pv=\"2\"", nullptr,
+     omnik_inverter::REALTIME_FIELD_PV2_CURRENT},
+    {"pv_current_amperes", "pv=\"3\"", nullptr,
+     omnik_inverter::REALTIME_FIELD_PV3_CURRENT},
+    {"grid_current_amperes", "phase=\"r\"", "Current of the grid phase.",
+     omnik_inverter::REALTIME_FIELD_R_CURRENT},
+    {"grid_current_amperes", "phase=\"s\"", nullptr,
+     omnik_inverter::REALTIME_FIELD_S_CURRENT},
+    {"grid_current_amperes", "phase=\"t\"", nullptr,
+     omnik_inverter::REALTIME_FIELD_T_CURRENT},
+    {"grid_voltage_volts", "phase=\"r\"", "Voltage of the grid phase.",
+     omnik_inverter::REALTIME_FIELD_R_VOLTAGE},
+    {"grid_voltage_volts", "phase=\"s\"", nullptr,
+     omnik_inverter::REALTIME_FIELD_S_VOLTAGE},
+    {"grid_voltage_volts", "phase=\"t\"", nullptr,
+     omnik_inverter::REALTIME_FIELD_T_VOLTAGE},
+    {"grid_frequency_hertz", "phase=\"r\"", "Frequency of the grid phase.",
+     omnik_inverter::REALTIME_FIELD_R_FREQUENCY},
+    {"grid_frequency_hertz", "phase=\"s\"", nullptr,
+     omnik_inverter::REALTIME_FIELD_S_FREQUENCY},
+    {"grid_frequency_hertz", "phase=\"t\"", nullptr,
+     omnik_inverter::REALTIME_FIELD_T_FREQUENCY},
+    {"grid_power_kilowatts", "phase=\"r\"", "Power of the grid phase.",
+     omnik_inverter::REALTIME_FIELD_R_POWER},
+    {"grid_power_kilowatts", "phase=\"s\"", nullptr,
+     omnik_inverter::REALTIME_FIELD_S_POWER},
+    {"grid_power_kilowatts", "phase=\"t\"", nullptr,
+     omnik_inverter::REALTIME_FIELD_T_POWER},
+    {"energy_today_kilowatthours", nullptr, "Energy produced today.",
+     omnik_inverter::REALTIME_FIELD_ENERGY_TODAY},
+    {"energy_kilowatthours_total", nullptr, "Energy produced in total.",
+     omnik_inverter::REALTIME_FIELD_ENERGY_TOTAL},
+    {"operating_hours_total", nullptr, "Hours the inverter has been running.",
+     omnik_inverter::REALTIME_FIELD_HOURS_TOTAL},
+    {"run_state", nullptr, "Run state (0=Startup, 1=Online, 2=Waiting).",
+     omnik_inverter::REALTIME_FIELD_RUN_STATE},
+    {"grid_voltage_fault_volts", nullptr, "Grid voltage fault value.",
+     omnik_inverter::REALTIME_FIELD_GRID_VOLTAGE_FAULT_VALUE},
+    {"grid_frequency_fault_hertz", nullptr, "Grid frequency fault value.",
+     omnik_inverter::REALTIME_FIELD_GRID_FREQUENCY_FAULT_VALUE},
+    {"grid_impedance_fault", nullptr, "Grid impedance fault value.",
+     omnik_inverter::REALTIME_FIELD_GRID_IMPEDANCE_FAULT_VALUE},
+    {"temperature_fault_celsius", nullptr, "Temperature fault value.",
+     omnik_inverter::REALTIME_FIELD_TEMPERATURE_FAULT},
+    {"pv_voltage_fault_volts", nullptr, "PV voltage fault value.",
+     omnik_inverter::REALTIME_FIELD_PV_VOLTAGE_FAULT},
+    {"gfci_current_fault_amperes", nullptr, "GFCI current fault value.",
+     omnik_inverter::REALTIME_FIELD_GFCI_CURRENT_FAULT},
+    {"error_bitmap", nullptr, "Error message binary index.",
+     omnik_inverter::REALTIME_FIELD_ERROR_MESSAGE_BINARY_INDEX},
+};
+
+// The metrics of the link statistics.
+static const LinkMetric LINK_METRICS[] = {
+    {"received_bytes_total", "Number of received bytes.",
+     [](const LinkStatistics &s) { return s.nr_of_bytes; }},
+    {"messages_total", "Number of messages with a correct checksum.",
+     [](const LinkStatistics &s) { return s.nr_of_messages; }},
+    {"checksum_errors_total", "Number of messages with a checksum mismatch.",
+     [](const LinkStatistics &s) { return s.nr_of_checksum_errors; }},
+    {"timeouts_total", "Number of incomplete messages that were discarded.",
+     [](const LinkStatistics &s) { return s.nr_of_timeouts; }},
+    {"unknown_messages_total", "Number of unknown messages.",
+     [](const LinkStatistics &s) { return s.nr_of_unknown_messages; }},
+    {"dropped_messages_total",
+     "Number of messages dropped because the receive queue was full.",
+     [](const LinkStatistics &s) { return s.nr_of_dropped_messages; }},
+};
+
+/**
+ * Make a string usable as a label value.
+ */
+static std::string to_label_value(const std::string &value) {
+  std::string result = value;
+  for (char &c : result) {
+    if (c == '"' || c == '\\' || c == '\n') {
+      c = '_';
+    }
+  }
+  return result;
+}
+
+/**
+ * @see the header file.
+ */
+MetricsWriter::MetricsWriter(const std::vector<Device> &devices) {
+  this->samples_.reserve(devices.size());
+  for (const Device &device : devices) {
+    Sample sample{};
+    sample.name = device.name;
+    sample.link_statistics = device.base->get_link_statistics();
+    if (device.inverter != nullptr) {
+      sample.has_realtime_data = device.inverter->has_realtime_data();
+      sample.realtime_data = device.inverter->get_realtime_data();
+      sample.has_info = device.inverter->has_info();
+      sample.info = device.inverter->get_info();
+    }
+    this->samples_.push_back(sample);
+  }
+}
+
+/**
+ * @see the header file.
+ */
+int MetricsWriter::render_line() {
+  int length = -1;
+  while (length < 0) {
+    switch (this->section_) {
+    case SECTION_REALTIME: {
+      if (this->metric_ >= sizeof(REALTIME_METRICS) / sizeof(RealtimeMetric)) {
+        next_section();
+        break;
+      }
+      const RealtimeMetric &metric = REALTIME_METRICS[this->metric_];
+      if (!this->header_done_) {
+        this->header_done_ = true;
+        if (metric.help != nullptr) {
+          length = snprintf(this->line_, sizeof(this->line_),
+                            "# HELP " PREFIX "%s %s\n# TYPE " PREFIX
+                            "%s gauge\n",
+                            metric.name, metric.help, metric.name);
+        }
+        break;
+      }
+      if (this->device_ >= this->samples_.size()) {
+        next_metric();
+        break;
+      }
+      const Sample &sample = this->samples_[this->device_++];
+      if (!sample.has_realtime_data) {
+        break;
+      }
+      length = 0;
+      append(length, PREFIX "%s{device=\"%s\"%s%s} ", metric.name,
+             sample.name, metric.label == nullptr ? "" : ",",
+             metric.label == nullptr ? "" : metric.label);
+      const RealtimeData &data = sample.realtime_data;
+      append_value(length,
+                   omnik_inverter::get_realtime_field(data, metric.field),
+                   omnik_inverter::get_realtime_field_decimals(metric.field));
+      append(length, "\n");
+      break;
+    }
+
+    case SECTION_LINK: {
+      if (this->metric_ >= sizeof(LINK_METRICS) / sizeof(LinkMetric)) {
+        next_section();
+        break;
+      }
+      const LinkMetric &metric = LINK_METRICS[this->metric_];
+      if (!this->header_done_) {
+        this->header_done_ = true;
+        length = snprintf(this->line_, sizeof(this->line_),
+                          "# HELP " PREFIX "%s %s\n# TYPE " PREFIX
+                          "%s counter\n",
+                          metric.name, metric.help, metric.name);
+        break;
+      }
+      if (this->device_ >= this->samples_.size()) {
+        next_metric();
+        break;
+      }
+      const Sample &sample = this->samples_[this->device_++];
+      length = snprintf(this->line_, sizeof(this->line_),
+                        PREFIX "%s{device=\"%s\"} %u\n", metric.name,
+                        sample.name,
+                        (unsigned) metric.value(sample.link_statistics));
+      break;
+    }
+
+    case SECTION_INFO: {
+      if (!this->header_done_) {
+        this->header_done_ = true;
+        length = snprintf(this->line_, sizeof(this->line_),
+                          "# HELP " PREFIX "inverter_info Information about "
+                          "the inverter.\n# TYPE " PREFIX "inverter_info "
+                          "gauge\n");
+        break;
+      }
+      if (this->device_ >= this->samples_.size()) {
+        next_section();
+        break;
+      }
+      const Sample &sample = this->samples_[this->device_++];
+      if (!sample.has_info) {
+        break;
+      }
+      const omnik_inverter::InverterInfo &info = sample.info;
+      length = snprintf(
+          this->line_, sizeof(this->line_),
+          PREFIX "inverter_info{device=\"%s\",serial_number=\"%s\","
+                 "model=\"%s\",brand=\"%s\",rated_power=\"%s\","
+                 "country=\"%s\",phases=\"%u\",firmware_main=\"%s\","
+                 "firmware_slave=\"%s\"} 1\n",
+          sample.name, to_label_value(info.serial_number).c_str(),
+          to_label_value(info.inverter_model).c_str(),
+          to_label_value(info.brand).c_str(),
+          to_label_value(info.rated_power).c_str(),
+          to_label_value(info.country).c_str(), info.nr_of_phases,
+          info.firmware_version_main.c_str(),
+          info.firmware_version_slave.c_str());
+      break;
+    }
+
+    default:
+      return -1;
+    }
+  }
+  return length;
+}
+
+} // namespace omnik_http
+} // namespace esphome
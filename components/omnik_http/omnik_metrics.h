@@ -0,0 +1,89 @@
+#pragma once
+
+#include "omnik_http.h"
+#include "omnik_line_writer.h"
+
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace omnik_http {
+
+/**
+ * This class is responsible for rendering the values of the Omnik devices in
+ * the Prometheus text format, one line at a time.
+ *
+ * The values are copied when the writer is created, so that all the lines of
+ * one response contain the values of the same messages.
+ */
+class MetricsWriter : public LineWriter {
+public:
+  /**
+   * Create a writer for the values of the devices.
+   *
+   * @param devices The devices of which the values are rendered.
+   */
+  MetricsWriter(const std::vector<Device> &devices);
+
+protected:
+  /**
+   * Render the next line in line_.
+   */
+  int render_line() override;
+
+private:
+  /**
+   * The values of a device.
+   */
+  struct Sample {
+    const char *name;
+    bool has_realtime_data;
+    omnik_inverter::RealtimeData realtime_data;
+    omnik_base::LinkStatistics link_statistics;
+    bool has_info;
+    omnik_inverter::InverterInfo info;
+  };
+
+  /**
+   * The sections of the response.
+   */
+  enum Section : uint8_t {
+    SECTION_REALTIME,
+    SECTION_LINK,
+    SECTION_INFO,
+    SECTION_END,
+  };
+
+  // The values of the devices.
+  std::vector<Sample> samples_;
+  // The current section.
+  Section section_{SECTION_REALTIME};
+  // The index of the current metric within the section.
+  size_t metric_{0};
+  // The index of the next device of the current metric.
+  size_t device_{0};
+  // True in case the header of the current metric has been rendered.
+  bool header_done_{false};
+
+  /**
+   * Go to the next metric within the current section.
+   */
+  void next_metric() {
+    this->metric_++;
+    this->device_ = 0;
+    this->header_done_ = false;
+  }
+
+  /**
+   * Go to the first metric of the next section.
+   */
+  void next_section() {
+    this->section_ = static_cast<Section>(this->section_ + 1);
+    this->metric_ = 0;
+    this->device_ = 0;
+    this->header_done_ = false;
+  }
+};
+
+} // namespace omnik_http
+} // namespace esphome
@@ -1,16 +1,22 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
+from esphome import automation
+import esphome.components.binary_sensor as bs
 import esphome.components.sensor as s
 import esphome.components.text_sensor as ts
+from esphome.core import CORE
 from esphome.const import (
     CONF_ACCURACY_DECIMALS,
     CONF_DEVICE_CLASS,
     CONF_ENTITY_CATEGORY,
     CONF_ID,
     CONF_INTERNAL,
+    CONF_INTERVAL,
     CONF_NAME,
+    CONF_SIZE,
     CONF_STATE_CLASS,
-    CONF_TEMPERATURE,
+    CONF_TIMEOUT,
+    CONF_TRIGGER_ID,
     CONF_UNIT_OF_MEASUREMENT,
     DEVICE_CLASS_CONDUCTIVITY,
     DEVICE_CLASS_CURRENT,
@@ -18,6 +24,7 @@ from esphome.const import (
     DEVICE_CLASS_ENERGY,
     DEVICE_CLASS_FREQUENCY,
     DEVICE_CLASS_POWER,
+    DEVICE_CLASS_PROBLEM,
     DEVICE_CLASS_TEMPERATURE,
     DEVICE_CLASS_VOLTAGE,
     ENTITY_CATEGORY_DIAGNOSTIC,
@@ -37,15 +44,22 @@ from esphome.const import (
 )
 from ..omnik_base import (
     to_code_base,
+    validate_base,
     OmnikBase,
     CONFIG_SCHEMA_BASE,
 )
+from .realtime_fields import (
+    REALTIME_FIELD_DECIMALS,
+    generate_realtime_fields,
+)
 
 AUTO_LOAD = [
+    "binary_sensor",
     "omnik_base",
     "sensor",
     "text_sensor",
 ]
+MULTI_CONF = True
 
 omnik_inverter_ns = cg.esphome_ns.namespace("omnik_inverter")
 OmnikInverter = omnik_inverter_ns.class_(
@@ -53,53 +67,257 @@ OmnikInverter = omnik_inverter_ns.class_(
     OmnikBase,
     cg.Component,
 )
+RealtimeSample = omnik_inverter_ns.struct("RealtimeSample")
+SampleTrigger = omnik_inverter_ns.class_(
+    "SampleTrigger",
+    automation.Trigger.template(RealtimeSample),
+)
+
+RealtimeField = omnik_inverter_ns.enum("RealtimeField")
+# The key in CORE.data that records that the REALTIME_FIELDS table is added.
+KEY_REALTIME_FIELDS = "omnik_inverter_realtime_fields"
+
+# The RealtimeField of the fields of RealtimeData, by name.
+REALTIME_FIELDS = {
+    name: getattr(RealtimeField, f"REALTIME_FIELD_{name.upper()}")
+    for name in REALTIME_FIELD_DECIMALS
+}
+
+def realtime_sensor(name, unit, device_class, state_class, internal=False):
+    """
+    Get the schema and the default configuration of the sensor of a field of
+    RealtimeData. The accuracy is the number of decimals of the field.
+    """
+    default = {
+        CONF_NAME: f"Inverter {name}",
+        CONF_UNIT_OF_MEASUREMENT: unit,
+        CONF_STATE_CLASS: state_class,
+        CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
+    }
+    if device_class is not None:
+        default[CONF_DEVICE_CLASS] = device_class
+    if internal:
+        default[CONF_INTERNAL] = True
+    return s.sensor_schema, default
+
+def realtime_text_sensor(name):
+    """
+    Get the schema and the default configuration of the text sensor of a field
+    of RealtimeData.
+    """
+    return ts.text_sensor_schema, {
+        CONF_NAME: f"Inverter {name}",
+        CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_DIAGNOSTIC,
+    }
+
+# The sensors of the fields of RealtimeData (Omnik 0x11/0x90 message).
+REALTIME_SENSORS = {
+    "temperature": realtime_sensor(
+        "Temperature", UNIT_CELSIUS, DEVICE_CLASS_TEMPERATURE,
+        STATE_CLASS_MEASUREMENT),
+    "pv1_voltage": realtime_sensor(
+        "PV1 voltage", UNIT_VOLT, DEVICE_CLASS_VOLTAGE,
+        STATE_CLASS_MEASUREMENT),
+    "pv2_voltage": realtime_sensor(
+        "PV2 voltage", UNIT_VOLT, DEVICE_CLASS_VOLTAGE,
+        STATE_CLASS_MEASUREMENT, internal=True),
+    "pv3_voltage": realtime_sensor(
+        "PV3 voltage", UNIT_VOLT, DEVICE_CLASS_VOLTAGE,
+        STATE_CLASS_MEASUREMENT, internal=True),
+    "pv1_current": realtime_sensor(
+        "PV1 current", UNIT_AMPERE, DEVICE_CLASS_CURRENT,
+        STATE_CLASS_MEASUREMENT),
+    "pv2_current": realtime_sensor(
+        "PV2 current", UNIT_AMPERE, DEVICE_CLASS_CURRENT,
+        STATE_CLASS_MEASUREMENT, internal=True),
+    "pv3_current": realtime_sensor(
+        "PV3 current", UNIT_AMPERE, DEVICE_CLASS_CURRENT,
+        STATE_CLASS_MEASUREMENT, internal=True),
+    "r_current": realtime_sensor(
+        "R current", UNIT_AMPERE, DEVICE_CLASS_CURRENT,
+        STATE_CLASS_MEASUREMENT),
+    "s_current": realtime_sensor(
+        "S current", UNIT_AMPERE, DEVICE_CLASS_CURRENT,
+        STATE_CLASS_MEASUREMENT, internal=True),
+    "t_current": realtime_sensor(
+        "T current", UNIT_AMPERE, DEVICE_CLASS_CURRENT,
+        STATE_CLASS_MEASUREMENT, internal=True),
+    "r_voltage": realtime_sensor(
+        "R voltage", UNIT_VOLT, DEVICE_CLASS_VOLTAGE,
+        STATE_CLASS_MEASUREMENT),
+    "s_voltage": realtime_sensor(
+        "S voltage", UNIT_VOLT, DEVICE_CLASS_VOLTAGE,
+        STATE_CLASS_MEASUREMENT, internal=True),
+    "t_voltage": realtime_sensor(
+        "T voltage", UNIT_VOLT, DEVICE_CLASS_VOLTAGE,
+        STATE_CLASS_MEASUREMENT, internal=True),
+    "r_frequency": realtime_sensor(
+        "R frequency", UNIT_HERTZ, DEVICE_CLASS_FREQUENCY,
+        STATE_CLASS_MEASUREMENT),
+    "r_power": realtime_sensor(
+        "R power", UNIT_KILOWATT, DEVICE_CLASS_POWER,
+        STATE_CLASS_MEASUREMENT),
+    "s_frequency": realtime_sensor(
+        "S frequency", UNIT_HERTZ, DEVICE_CLASS_FREQUENCY,
+        STATE_CLASS_MEASUREMENT, internal=True),
+    "s_power": realtime_sensor(
+        "S power", UNIT_KILOWATT, DEVICE_CLASS_POWER,
+        STATE_CLASS_MEASUREMENT, internal=True),
+    "t_frequency": realtime_sensor(
+        "T frequency", UNIT_HERTZ, DEVICE_CLASS_FREQUENCY,
+        STATE_CLASS_MEASUREMENT, internal=True),
+    "t_power": realtime_sensor(
+        "T power", UNIT_KILOWATT, DEVICE_CLASS_POWER,
+        STATE_CLASS_MEASUREMENT, internal=True),
+    "energy_today": realtime_sensor(
+        "Energy today", UNIT_KILOWATT_HOURS, DEVICE_CLASS_ENERGY,
+        STATE_CLASS_TOTAL_INCREASING),
+    "energy_total": realtime_sensor(
+        "Energy total", UNIT_KILOWATT_HOURS, DEVICE_CLASS_ENERGY,
+        STATE_CLASS_TOTAL),
+    "hours_total": realtime_sensor(
+        "Hours total", UNIT_HOUR, DEVICE_CLASS_EMPTY, STATE_CLASS_TOTAL),
+    "run_state": realtime_text_sensor("Run state"),
+    "grid_voltage_fault_value": realtime_sensor(
+        "Grid voltage fault", UNIT_VOLT, DEVICE_CLASS_VOLTAGE,
+        STATE_CLASS_MEASUREMENT),
+    "grid_frequency_fault_value": realtime_sensor(
+        "Grid frequence fault", UNIT_HERTZ, DEVICE_CLASS_FREQUENCY,
+        STATE_CLASS_MEASUREMENT),
+    "grid_impedance_fault_value": realtime_sensor(
+        "Grid impedance fault", UNIT_DEGREES, None, STATE_CLASS_MEASUREMENT),
+    "temperature_fault": realtime_sensor(
+        "Temperature fault", UNIT_CELSIUS, DEVICE_CLASS_TEMPERATURE,
+        STATE_CLASS_MEASUREMENT),
+    "pv_voltage_fault": realtime_sensor(
+        "PV voltage fault", UNIT_VOLT, DEVICE_CLASS_VOLTAGE,
+        STATE_CLASS_MEASUREMENT),
+    "gfci_current_fault": realtime_sensor(
+        "GFCI current fault", UNIT_AMPERE, DEVICE_CLASS_CURRENT,
+        STATE_CLASS_MEASUREMENT),
+    "error_message_binary_index": realtime_text_sensor("Error index"),
+}
+assert list(REALTIME_SENSORS) == list(REALTIME_FIELDS), \
+    "REALTIME_SENSORS doesn't match REALTIME_FIELD_DECIMALS"
 
+def realtime_sensor_schemas():
+    """
+    Get the schemas of the sensors of the fields of RealtimeData.
+    """
+    schemas = {}
+    for name, (schema, default) in REALTIME_SENSORS.items():
+        if schema is s.sensor_schema:
+            default = {
+                **default,
+                CONF_ACCURACY_DECIMALS: REALTIME_FIELD_DECIMALS[name],
+            }
+        schemas[cv.Optional(name, default=default)] = schema()
+    return schemas
+
+# The names of the bits of the error bitmap (the error message binary index):
+# the error messages of the Omnik manuals, in the order of the bits. The other
+# bits have a generic name.
+FAULT_NAMES = {
+    0: "Isolation fault",
+    1: "Ground current fault",
+    2: "Grid fault",
+    3: "Grid frequency fault",
+    4: "PV over voltage",
+    5: "Over temperature",
+    6: "Grid voltage fault",
+    7: "No utility",
+    8: "Consistent fault",
+    9: "Relay check fault",
+    10: "DC injection high",
+    11: "EEPROM fault",
+    12: "SCI failure",
+    13: "High DC bus",
+    14: "GFCI device fault",
+    15: "Auto test fault",
+    16: "DC sensor fault",
+}
+
+CONF_BIT = "bit"
 CONF_BRAND = "brand"
 CONF_COUNTRY = "country"
-CONF_ENERGY_TODAY = "energy_today"
-CONF_ENERGY_TOTAL = "energy_total"
-CONF_ERROR_MESSAGE_BINARY_INDEX = "error_message_binary_index"
+CONF_FAULTS = "faults"
+CONF_FIELDS = "fields"
 CONF_FIRMWARE_VERSION_MAIN = "firmware_version_main"
 CONF_FIRMWARE_VERSION_SLAVE = "firmware_version_slave"
-CONF_GFCI_CURRENT_FAULT = "gfci_current_fault"
-CONF_GRID_FREQUENCY_FAULT_VALUE = "grid_frequency_fault_value"
-CONF_GRID_IMPEDANCE_FAULT_VALUE = "grid_impedance_fault_value"
-CONF_GRID_VOLTAGE_FAULT_VALUE = "grid_voltage_fault_value"
-CONF_HOURS_TOTAL = "hours_total"
+CONF_HISTORY = "history"
 CONF_INVERTER_MODEL = "inverter_model"
 CONF_MESSAGE_11_83_BYTES_60_77 = "message_11_83_bytes_60_77"
 CONF_NR_OF_ALARMS = "nr_of_alarms"
 CONF_NR_OF_PHASES = "nr_of_phases"
-CONF_PV1_CURRENT = "pv1_current"
-CONF_PV1_VOLTAGE = "pv1_voltage"
-CONF_PV2_CURRENT = "pv2_current"
-CONF_PV2_VOLTAGE = "pv2_voltage"
-CONF_PV3_CURRENT = "pv3_current"
-CONF_PV3_VOLTAGE = "pv3_voltage"
-CONF_PV_VOLTAGE_FAULT = "pv_voltage_fault"
+CONF_ON_SAMPLE = "on_sample"
 CONF_RATED_POWER = "rated_power"
-CONF_R_CURRENT = "r_current"
-CONF_R_FREQUENCY = "r_frequency"
-CONF_R_POWER = "r_power"
-CONF_RUN_STATE = "run_state"
-CONF_R_VOLTAGE = "r_voltage"
-CONF_S_CURRENT = "s_current"
+CONF_POWER_SAVE = "power_save"
+CONF_PUBLISH_SENSORS = "publish_sensors"
+CONF_SNAPSHOT = "snapshot"
+CONF_SERIAL_NUMBER = "serial_number"
 CONF_SERIAL_DEVICE_NUMBER = "serial_device_number"
-CONF_S_FREQUENCY = "s_frequency"
-CONF_S_POWER = "s_power"
 CONF_STATUS_10_81 = "status_10_81"
 CONF_STATUS_10_84 = "status_10_84"
 CONF_STATUS_12_C0 = "status_12_c0"
 CONF_STATUS_12_C1 = "status_12_c1"
-CONF_S_VOLTAGE = "s_voltage"
-CONF_T_CURRENT = "t_current"
-CONF_TEMPERATURE_FAULT = "temperature_fault"
-CONF_T_FREQUENCY = "t_frequency"
-CONF_T_POWER = "t_power"
-CONF_T_VOLTAGE = "t_voltage"
 
-CONFIG_SCHEMA = CONFIG_SCHEMA_BASE.extend({
+def set_fault_name(config):
+    """
+    Name a fault binary sensor after its bit (FAULT_NAMES), in case it has no
+    name.
+    """
+    if CONF_NAME not in config:
+        bit = config[CONF_BIT]
+        name = FAULT_NAMES.get(bit, f"Fault bit {bit}")
+        config[CONF_NAME] = f"Inverter {name}"
+    return config
+
+def validate_fault_bits(faults):
+    """
+    Check that each bit of the error bitmap is used only once.
+    """
+    bits = [fault[CONF_BIT] for fault in faults]
+    for bit in bits:
+        if bits.count(bit) > 1:
+            raise cv.Invalid(f"Fault bit {bit} is used more than once")
+    return faults
+
+FAULT_SCHEMA = cv.All(
+    bs.binary_sensor_schema(
+        device_class=DEVICE_CLASS_PROBLEM,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ).extend({
+        cv.Required(CONF_BIT): cv.int_range(min=0, max=31),
+    }),
+    set_fault_name,
+)
+
+CONFIG_SCHEMA = cv.All(CONFIG_SCHEMA_BASE.extend({
     cv.GenerateID(): cv.declare_id(OmnikInverter),
+    cv.Optional(CONF_SERIAL_NUMBER): cv.string_strict,
+    cv.Optional(CONF_PUBLISH_SENSORS, default=True): cv.boolean,
+    cv.Optional(CONF_HISTORY): cv.Schema({
+        cv.Optional(CONF_SIZE, default=4096): cv.int_range(min=512,
+                                                           max=65536),
+        cv.Optional(CONF_INTERVAL, default="60s"):
+            cv.positive_time_period_seconds,
+        cv.Optional(CONF_FIELDS,
+                    default=[
+                        "energy_today",
+                        "r_power",
+                        "pv1_voltage",
+                        "pv1_current",
+                        "temperature",
+                    ]): cv.All(cv.ensure_list(cv.enum(REALTIME_FIELDS)),
+                               cv.Length(min=1, max=32)),
+    }),
+    cv.Optional(CONF_ON_SAMPLE): automation.validate_automation({
+        cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(SampleTrigger),
+    }),
+    cv.Optional(CONF_POWER_SAVE): cv.Schema({
+        cv.Optional(CONF_TIMEOUT, default="10min"):
+            cv.positive_time_period_milliseconds,
+    }),
     # Omnik 0x10/0x80 message.
     cv.Optional(CONF_SERIAL_DEVICE_NUMBER,
                 default={
@@ -160,279 +378,10 @@ CONFIG_SCHEMA = CONFIG_SCHEMA_BASE.extend({
                     CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_DIAGNOSTIC,
                 }): ts.text_sensor_schema(),
     # Omnik 0x11/0x90 message.
-    cv.Optional(CONF_TEMPERATURE,
-                default={
-                    CONF_NAME: "Inverter Temperature",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_CELSIUS,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_TEMPERATURE,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 1,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_PV1_VOLTAGE,
-                default={
-                    CONF_NAME: "Inverter PV1 voltage",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_VOLT,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_VOLTAGE,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 1,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_PV2_VOLTAGE,
-                default={
-                    CONF_NAME: "Inverter PV2 voltage",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_VOLT,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_VOLTAGE,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 1,
-                    CONF_INTERNAL: True,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_PV3_VOLTAGE,
-                default={
-                    CONF_NAME: "Inverter PV3 voltage",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_VOLT,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_VOLTAGE,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 1,
-                    CONF_INTERNAL: True,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_PV1_CURRENT,
-                default={
-                    CONF_NAME: "Inverter PV1 current",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_AMPERE,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_CURRENT,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 1,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_PV2_CURRENT,
-                default={
-                    CONF_NAME: "Inverter PV2 current",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_AMPERE,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_CURRENT,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 1,
-                    CONF_INTERNAL: True,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_PV3_CURRENT,
-                default={
-                    CONF_NAME: "Inverter PV3 current",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_AMPERE,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_CURRENT,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 1,
-                    CONF_INTERNAL: True,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_R_CURRENT,
-                default={
-                    CONF_NAME: "Inverter R current",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_AMPERE,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_CURRENT,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 1,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_S_CURRENT,
-                default={
-                    CONF_NAME: "Inverter S current",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_AMPERE,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_CURRENT,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 1,
-                    CONF_INTERNAL: True,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_T_CURRENT,
-                default={
-                    CONF_NAME: "Inverter T current",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_AMPERE,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_CURRENT,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 1,
-                    CONF_INTERNAL: True,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_R_VOLTAGE,
-                default={
-                    CONF_NAME: "Inverter R voltage",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_VOLT,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_VOLTAGE,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 1,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_S_VOLTAGE,
-                default={
-                    CONF_NAME: "Inverter S voltage",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_VOLT,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_VOLTAGE,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 1,
-                    CONF_INTERNAL: True,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_T_VOLTAGE,
-                default={
-                    CONF_NAME: "Inverter T voltage",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_VOLT,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_VOLTAGE,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 1,
-                    CONF_INTERNAL: True,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_R_FREQUENCY,
-                default={
-                    CONF_NAME: "Inverter R frequency",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_HERTZ,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_FREQUENCY,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 2,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_R_POWER,
-                default={
-                    CONF_NAME: "Inverter R power",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_KILOWATT,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_POWER,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 3,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_S_FREQUENCY,
-                default={
-                    CONF_NAME: "Inverter S frequency",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_HERTZ,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_FREQUENCY,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 2,
-                    CONF_INTERNAL: True,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_S_POWER,
-                default={
-                    CONF_NAME: "Inverter S power",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_KILOWATT,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_POWER,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 3,
-                    CONF_INTERNAL: True,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_T_FREQUENCY,
-                default={
-                    CONF_NAME: "Inverter T frequency",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_HERTZ,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_FREQUENCY,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 2,
-                    CONF_INTERNAL: True,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_T_POWER,
-                default={
-                    CONF_NAME: "Inverter T power",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_KILOWATT,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_POWER,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 3,
-                    CONF_INTERNAL: True,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_ENERGY_TODAY,
-                default={
-                    CONF_NAME: "Inverter Energy today",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_KILOWATT_HOURS,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_ENERGY,
-                    CONF_STATE_CLASS: STATE_CLASS_TOTAL_INCREASING,
-                    CONF_ACCURACY_DECIMALS: 2,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_ENERGY_TOTAL,
-                default={
-                    CONF_NAME: "Inverter Energy total",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_KILOWATT_HOURS,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_ENERGY,
-                    CONF_STATE_CLASS: STATE_CLASS_TOTAL,
-                    CONF_ACCURACY_DECIMALS: 1,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_HOURS_TOTAL,
-                default={
-                    CONF_NAME: "Inverter Hours total",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_HOUR,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_EMPTY,
-                    CONF_STATE_CLASS: STATE_CLASS_TOTAL,
-                    CONF_ACCURACY_DECIMALS: 0,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_RUN_STATE,
-                default={
-                    CONF_NAME: "Inverter Run state",
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_DIAGNOSTIC,
-                }): ts.text_sensor_schema(),
-    cv.Optional(CONF_GRID_VOLTAGE_FAULT_VALUE,
-                default={
-                    CONF_NAME: "Inverter Grid voltage fault",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_VOLT,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_VOLTAGE,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 1,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_GRID_FREQUENCY_FAULT_VALUE,
-                default={
-                    CONF_NAME: "Inverter Grid frequence fault",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_HERTZ,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_FREQUENCY,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 2,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_GRID_IMPEDANCE_FAULT_VALUE,
-                default={
-                    CONF_NAME: "Inverter Grid impedance fault",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_DEGREES,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 3,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_TEMPERATURE_FAULT,
-                default={
-                    CONF_NAME: "Inverter Temperature fault",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_CELSIUS,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_TEMPERATURE,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 1,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_PV_VOLTAGE_FAULT,
-                default={
-                    CONF_NAME: "Inverter PV voltage fault",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_VOLT,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_VOLTAGE,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 1,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_GFCI_CURRENT_FAULT,
-                default={
-                    CONF_NAME: "Inverter GFCI current fault",
-                    CONF_UNIT_OF_MEASUREMENT: UNIT_AMPERE,
-                    CONF_DEVICE_CLASS: DEVICE_CLASS_CURRENT,
-                    CONF_STATE_CLASS: STATE_CLASS_MEASUREMENT,
-                    CONF_ACCURACY_DECIMALS: 3,
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_NONE,
-                }): s.sensor_schema(),
-    cv.Optional(CONF_ERROR_MESSAGE_BINARY_INDEX,
-                default={
-                    CONF_NAME: "Inverter Error index",
-                    CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_DIAGNOSTIC,
-                }): ts.text_sensor_schema(),
+    **realtime_sensor_schemas(),
+    cv.Optional(CONF_FAULTS): cv.All(cv.ensure_list(FAULT_SCHEMA),
+                                     validate_fault_bits),
+    cv.Optional(CONF_SNAPSHOT): ts.text_sensor_schema(),
     # Omnik 0x11/0xC3 message.
     cv.Optional(CONF_NR_OF_ALARMS,
                 default={
@@ -455,21 +404,61 @@ CONFIG_SCHEMA = CONFIG_SCHEMA_BASE.extend({
                     CONF_NAME: "Inverter Status 0x12/0xC1",
                     CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_DIAGNOSTIC,
                 }): ts.text_sensor_schema(),
-})
+}), validate_base("Inverter"))
+
+def add_realtime_fields():
+    """
+    Add the REALTIME_FIELDS table, which is generated from realtime_fields.py,
+    once for all the inverters.
+    """
+    if CORE.data.get(KEY_REALTIME_FIELDS):
+        return
+    CORE.data[KEY_REALTIME_FIELDS] = True
+    cg.add_global(cg.RawStatement(generate_realtime_fields()))
 
 async def to_code(config):
+    add_realtime_fields()
     comp = await to_code_base(config)
+    if CONF_SERIAL_NUMBER in config:
+        cg.add(comp.set_serial_number(config[CONF_SERIAL_NUMBER]))
+    cg.add(comp.set_publish_sensors(config[CONF_PUBLISH_SENSORS]))
+    if CONF_HISTORY in config:
+        history_config = config[CONF_HISTORY]
+        cg.add(comp.set_history(history_config[CONF_SIZE],
+                                history_config[CONF_INTERVAL].total_seconds))
+        for field in history_config[CONF_FIELDS]:
+            cg.add(comp.add_history_field(REALTIME_FIELDS[field]))
+    if CONF_POWER_SAVE in config:
+        power_save_config = config[CONF_POWER_SAVE]
+        cg.add(comp.set_power_save(
+            power_save_config[CONF_TIMEOUT].total_milliseconds))
+    for trigger_config in config.get(CONF_ON_SAMPLE, []):
+        trigger = cg.new_Pvariable(trigger_config[CONF_TRIGGER_ID], comp)
+        await automation.build_automation(trigger, [(RealtimeSample, "sample")],
+                                          trigger_config)
+    for fault_config in config.get(CONF_FAULTS, []):
+        binary_sensor = await bs.new_binary_sensor(fault_config)
+        cg.add(comp.add_fault_binary_sensor(fault_config[CONF_BIT],
+                                            binary_sensor))
 
     for sensor_key in config:
         sensor_config = config[sensor_key]
-        if not isinstance(sensor_config, dict):
+        if not isinstance(sensor_config, dict) or CONF_ID not in sensor_config:
+            continue
+        # Without publish_sensors the sensors of RealtimeData are never
+        # published, so they aren't created at all.
+        if sensor_key in REALTIME_SENSORS and not config[CONF_PUBLISH_SENSORS]:
             continue
         sensor_id = sensor_config[CONF_ID]
         sensor_type = sensor_id.type
         match sensor_type.base:
             case s.Sensor.base:
                 sensor = await s.new_sensor(sensor_config)
-                cg.add(getattr(comp, f"set_{sensor_key}_sensor")(sensor))
+                if sensor_key in REALTIME_FIELDS:
+                    cg.add(comp.set_realtime_sensor(
+                        REALTIME_FIELDS[sensor_key], sensor))
+                else:
+                    cg.add(getattr(comp, f"set_{sensor_key}_sensor")(sensor))
             case ts.TextSensor.base:
                 sensor = await ts.new_text_sensor(sensor_config)
                 cg.add(getattr(comp, f"set_{sensor_key}_text_sensor")(sensor))
@@ -1,11 +1,22 @@
 #include "omnik_inverter.h"
 #include <bitset>
+#include <cinttypes>
+#include <cstdio>
 
 namespace esphome {
 namespace omnik_inverter {
 
+using omnik_base::ChangedTextState;
+
 // Tag that is used for log messages.
-static const char *const TAG = "omnik_inverter";
+static const char *const TAG = OmnikInverter::LOG_TAG;
+
+// The longest snapshot: the longest state of a text sensor that Home
+// Assistant accepts.
+static const size_t MAX_SNAPSHOT_LENGTH = 255;
+
+// The run state of an inverter that is asleep for the night.
+static const uint16_t RUN_STATE_WAITING = 2;
 
 /**
  * Convert an integer value to a run state string.
@@ -16,7 +27,7 @@ static std::string to_run_state(uint16_t run_state) {
     return "Startup";
   case 1:
     return "Online";
-  case 2:
+  case RUN_STATE_WAITING:
     return "Waiting";
   default:
     return std::to_string(run_state);
@@ -24,19 +35,72 @@ static std::string to_run_state(uint16_t run_state) {
 }
 
 /**
- * Convert an integer value to a version string.
+ * Get the values of the final sample of an idle inverter: the temperature,
+ * the counters and the errors of the last sample, but no voltage, current,
+ * frequency or power.
  */
-static std::string to_version(uint32_t version) {
-  unsigned int build = version % 10000;
-  version /= 10000;
-  unsigned int minor = version % 100;
-  version /= 100;
-  unsigned int major = version;
+static RealtimeData to_idle_data(const RealtimeData &data) {
+  RealtimeData idle_data{};
+  idle_data.temperature = data.temperature;
+  idle_data.energy_today = data.energy_today;
+  idle_data.energy_total = data.energy_total;
+  idle_data.hours_total = data.hours_total;
+  idle_data.run_state = RUN_STATE_WAITING;
+  idle_data.error_message_binary_index = data.error_message_binary_index;
+  return idle_data;
+}
 
-  char buffer[32];
-  snprintf(buffer, sizeof(buffer), "V%d.%02dBuild%d", major, minor, build);
+// The sensors and text sensors of the inverter, except the realtime sensors.
+const OmnikInverter::SensorEntry OmnikInverter::SENSORS[] = {
+    // Sensors of Omnik 0x10/0x80 message.
+    {"serial_device_number", nullptr,
+     &OmnikInverter::serial_device_number_text_sensor_},
+    // Sensors of Omnik 0x10/0x81 message.
+    {"status_10_81", nullptr, &OmnikInverter::status_10_81_text_sensor_},
+    // Sensors of Omnik 0x10/0x84 message.
+    {"status_10_84", nullptr, &OmnikInverter::status_10_84_text_sensor_},
+    // Sensors of Omnik 0x11/0x83 message.
+    {"nr_of_phases", nullptr, &OmnikInverter::nr_of_phases_text_sensor_},
+    {"rated_power", nullptr, &OmnikInverter::rated_power_text_sensor_},
+    {"country", nullptr, &OmnikInverter::country_text_sensor_},
+    {"firmware_version_main", nullptr,
+     &OmnikInverter::firmware_version_main_text_sensor_},
+    {"firmware_version_slave", nullptr,
+     &OmnikInverter::firmware_version_slave_text_sensor_},
+    {"inverter_model", nullptr, &OmnikInverter::inverter_model_text_sensor_},
+    {"brand", nullptr, &OmnikInverter::brand_text_sensor_},
+    {"message_11_83_bytes_60_77", nullptr,
+     &OmnikInverter::message_11_83_bytes_60_77_text_sensor_},
+    // Text sensors of Omnik 0x11/0x90 message.
+    {"run_state", nullptr, &OmnikInverter::run_state_text_sensor_},
+    {"error_message_binary_index", nullptr,
+     &OmnikInverter::error_message_binary_index_text_sensor_},
+    {"snapshot", nullptr, &OmnikInverter::snapshot_text_sensor_},
+    // Sensors of Omnik 0x11/0xC3 message.
+    {"nr_of_alarms", &OmnikInverter::nr_of_alarms_sensor_, nullptr},
+    // Sensors of Omnik 0x12/0xC0 message.
+    {"status_12_c0", nullptr, &OmnikInverter::status_12_c0_text_sensor_},
+    // Sensors of Omnik 0x12/0xC1 message.
+    {"status_12_c1", nullptr, &OmnikInverter::status_12_c1_text_sensor_},
+};
 
-  return std::string(buffer);
+/**
+ * @see the header file.
+ */
+void OmnikInverter::setup() {
+  OmnikBase::setup();
+  // The slot of a realtime sensor is its RealtimeField.
+  for (sensor::Sensor *sensor : realtime_sensors_) {
+    publish_scheduler_.add_slot(sensor);
+  }
+  run_state_slot_ = publish_scheduler_.add_slot(run_state_text_sensor_);
+  if (history_size_ > 0) {
+    history_.init(history_size_, history_fields_.size());
+  }
+  if (power_save_timeout_ > 0) {
+    set_interval("idle_check", power_save_timeout_,
+                 [this]() { this->check_idle(); });
+  }
 }
 
 /**
@@ -45,330 +109,310 @@ static std::string to_version(uint32_t version) {
 void OmnikInverter::dump_config() {
   ESP_LOGCONFIG(TAG, "OmnikInverter:");
   omnik_base::dump_config(TAG, "  ", this);
-  // Dump sensors of Omnik 0x10/0x80 message.
-  ESP_LOGCONFIG(TAG, "  serial_device_number:");
-  omnik_base::dump_config(TAG, "    ", serial_device_number_text_sensor_);
-  // Dump sensors of Omnik 0x10/0x81 message.
-  ESP_LOGCONFIG(TAG, "  status_10_81:");
-  omnik_base::dump_config(TAG, "    ", status_10_81_text_sensor_);
-  // Dump sensors of Omnik 0x10/0x84 message.
-  ESP_LOGCONFIG(TAG, "  status_10_84:");
-  omnik_base::dump_config(TAG, "    ", status_10_84_text_sensor_);
-  // Dump sensors of Omnik 0x11/0x83 message.
-  ESP_LOGCONFIG(TAG, "  nr_of_phases:");
-  omnik_base::dump_config(TAG, "    ", nr_of_phases_text_sensor_);
-  ESP_LOGCONFIG(TAG, "  rated_power:");
-  omnik_base::dump_config(TAG, "    ", rated_power_text_sensor_);
-  ESP_LOGCONFIG(TAG, "  country:");
-  omnik_base::dump_config(TAG, "    ", country_text_sensor_);
-  ESP_LOGCONFIG(TAG, "  firmware_version_main:");
-  omnik_base::dump_config(TAG, "    ", firmware_version_main_text_sensor_);
-  ESP_LOGCONFIG(TAG, "  firmware_version_slave:");
-  omnik_base::dump_config(TAG, "    ", firmware_version_slave_text_sensor_);
-  ESP_LOGCONFIG(TAG, "  inverter_model:");
-  omnik_base::dump_config(TAG, "    ", inverter_model_text_sensor_);
-  ESP_LOGCONFIG(TAG, "  brand:");
-  omnik_base::dump_config(TAG, "    ", brand_text_sensor_);
-  ESP_LOGCONFIG(TAG, "  message_11_83_bytes_60_77:");
-  omnik_base::dump_config(TAG, "    ", message_11_83_bytes_60_77_text_sensor_);
-  // Dump sensors of Omnik 0x11/0x90 message.
-  ESP_LOGCONFIG(TAG, "  temperature:");
-  omnik_base::dump_config(TAG, "    ", temperature_sensor_);
-  ESP_LOGCONFIG(TAG, "  pv1_voltage:");
-  omnik_base::dump_config(TAG, "    ", pv1_voltage_sensor_);
-  ESP_LOGCONFIG(TAG, "  pv2_voltage:");
-  omnik_base::dump_config(TAG, "    ", pv2_voltage_sensor_);
-  ESP_LOGCONFIG(TAG, "  pv3_voltage:");
-  omnik_base::dump_config(TAG, "    ", pv3_voltage_sensor_);
-  ESP_LOGCONFIG(TAG, "  pv1_current:");
-  omnik_base::dump_config(TAG, "    ", pv1_current_sensor_);
-  ESP_LOGCONFIG(TAG, "  pv2_current:");
-  omnik_base::dump_config(TAG, "    ", pv2_current_sensor_);
-  ESP_LOGCONFIG(TAG, "  pv3_current:");
-  omnik_base::dump_config(TAG, "    ", pv3_current_sensor_);
-  ESP_LOGCONFIG(TAG, "  r_current:");
-  omnik_base::dump_config(TAG, "    ", r_current_sensor_);
-  ESP_LOGCONFIG(TAG, "  s_current:");
-  omnik_base::dump_config(TAG, "    ", s_current_sensor_);
-  ESP_LOGCONFIG(TAG, "  t_current:");
-  omnik_base::dump_config(TAG, "    ", t_current_sensor_);
-  ESP_LOGCONFIG(TAG, "  r_voltage:");
-  omnik_base::dump_config(TAG, "    ", r_voltage_sensor_);
-  ESP_LOGCONFIG(TAG, "  s_voltage:");
-  omnik_base::dump_config(TAG, "    ", s_voltage_sensor_);
-  ESP_LOGCONFIG(TAG, "  t_voltage:");
-  omnik_base::dump_config(TAG, "    ", t_voltage_sensor_);
-  ESP_LOGCONFIG(TAG, "  r_frequency:");
-  omnik_base::dump_config(TAG, "    ", r_frequency_sensor_);
-  ESP_LOGCONFIG(TAG, "  r_power:");
-  omnik_base::dump_config(TAG, "    ", r_power_sensor_);
-  ESP_LOGCONFIG(TAG, "  s_frequency:");
-  omnik_base::dump_config(TAG, "    ", s_frequency_sensor_);
-  ESP_LOGCONFIG(TAG, "  s_power:");
-  omnik_base::dump_config(TAG, "    ", s_power_sensor_);
-  ESP_LOGCONFIG(TAG, "  t_frequency:");
-  omnik_base::dump_config(TAG, "    ", t_frequency_sensor_);
-  ESP_LOGCONFIG(TAG, "  t_power:");
-  omnik_base::dump_config(TAG, "    ", t_power_sensor_);
-  ESP_LOGCONFIG(TAG, "  energy_today:");
-  omnik_base::dump_config(TAG, "    ", energy_today_sensor_);
-  ESP_LOGCONFIG(TAG, "  energy_total:");
-  omnik_base::dump_config(TAG, "    ", energy_total_sensor_);
-  ESP_LOGCONFIG(TAG, "  hours_total:");
-  omnik_base::dump_config(TAG, "    ", hours_total_sensor_);
-  ESP_LOGCONFIG(TAG, "  run_state:");
-  omnik_base::dump_config(TAG, "    ", run_state_text_sensor_);
-  ESP_LOGCONFIG(TAG, "  grid_voltage_fault_value:");
-  omnik_base::dump_config(TAG, "    ", grid_voltage_fault_value_sensor_);
-  ESP_LOGCONFIG(TAG, "  grid_frequency_fault_value:");
-  omnik_base::dump_config(TAG, "    ", grid_frequency_fault_value_sensor_);
-  ESP_LOGCONFIG(TAG, "  grid_impedance_fault_value:");
-  omnik_base::dump_config(TAG, "    ", grid_impedance_fault_value_sensor_);
-  ESP_LOGCONFIG(TAG, "  temperature_fault:");
-  omnik_base::dump_config(TAG, "    ", temperature_fault_sensor_);
-  ESP_LOGCONFIG(TAG, "  pv_voltage_fault:");
-  omnik_base::dump_config(TAG, "    ", pv_voltage_fault_sensor_);
-  ESP_LOGCONFIG(TAG, "  gfci_current_fault:");
-  omnik_base::dump_config(TAG, "    ", gfci_current_fault_sensor_);
-  ESP_LOGCONFIG(TAG, "  error_message_binary_index:");
-  omnik_base::dump_config(TAG, "    ", error_message_binary_index_text_sensor_);
-  // Dump sensors of Omnik 0x11/0xC3 message.
-  ESP_LOGCONFIG(TAG, "  nr_of_alarms:");
-  omnik_base::dump_config(TAG, "    ", nr_of_alarms_sensor_);
-  // Dump sensors of Omnik 0x12/0xC0 message.
-  ESP_LOGCONFIG(TAG, "  status_12_C0:");
-  omnik_base::dump_config(TAG, "    ", status_12_c0_text_sensor_);
-  // Dump sensors of Omnik 0x12/0xC1 message.
-  ESP_LOGCONFIG(TAG, "  status_12_C1:");
-  omnik_base::dump_config(TAG, "    ", status_12_c1_text_sensor_);
+  if (!serial_number_.empty()) {
+    ESP_LOGCONFIG(TAG, "  Serial number: %s", serial_number_.c_str());
+  }
+  for (const SensorEntry &entry : SENSORS) {
+    ESP_LOGCONFIG(TAG, "  %s:", entry.name);
+    if (entry.sensor != nullptr) {
+      omnik_base::dump_config(TAG, "    ", this->*entry.sensor);
+    } else {
+      omnik_base::dump_config(TAG, "    ", this->*entry.text_sensor);
+    }
+  }
+  for (uint8_t i = 0; i < NR_OF_REALTIME_FIELDS; i++) {
+    if (realtime_sensors_[i] != nullptr) {
+      ESP_LOGCONFIG(TAG, "  %s:", get_realtime_field_name((RealtimeField) i));
+      omnik_base::dump_config(TAG, "    ", realtime_sensors_[i]);
+    }
+  }
+  for (const FaultBinarySensor &fault : fault_binary_sensors_) {
+    ESP_LOGCONFIG(TAG, "  Fault bit %u: %s", fault.bit,
+                  fault.binary_sensor->get_name().c_str());
+  }
+  ESP_LOGCONFIG(TAG, "  Publish sensors: %s", YESNO(publish_sensors_));
+  if (power_save_timeout_ > 0) {
+    ESP_LOGCONFIG(TAG, "  Power save:");
+    ESP_LOGCONFIG(TAG, "    Timeout: %u ms", (unsigned) power_save_timeout_);
+  }
+  if (history_size_ > 0) {
+    ESP_LOGCONFIG(TAG, "  History:");
+    ESP_LOGCONFIG(TAG, "    Size: %u bytes", (unsigned) history_.get_size());
+    ESP_LOGCONFIG(TAG, "    Interval: %u s", (unsigned) history_interval_);
+    ESP_LOGCONFIG(TAG, "    Samples: %u",
+                  (unsigned) history_.get_nr_of_samples());
+    for (RealtimeField field : history_fields_) {
+      ESP_LOGCONFIG(TAG, "    Field: %s", get_realtime_field_name(field));
+    }
+  }
+  // Dump the changes of the bytes that aren't decoded.
+  message_11_83_bytes_60_77_variance_.dump(TAG, "message_11_83_bytes_60_77",
+                                           60);
 }
 
 /**
  * @see the header file.
  */
-void OmnikInverter::process_omnik_message(uint8_t control_code,
-                                          uint8_t function_code,
-                                          ByteBuffer &data) {
-  switch (OMNIK_MESSAGE_ID(control_code, function_code)) {
-  case OMNIK_MESSAGE_ID(0x10, 0x80):
-    omnik_message_10_80(data);
-    break;
-
-  case OMNIK_MESSAGE_ID(0x10, 0x81):
-    omnik_message_10_81(data);
-    break;
-
-  case OMNIK_MESSAGE_ID(0x10, 0x84):
-    omnik_message_10_84(data);
-    break;
-
-  case OMNIK_MESSAGE_ID(0x11, 0x83):
-    omnik_message_11_83(data);
-    break;
-
-  case OMNIK_MESSAGE_ID(0x11, 0x90):
-    omnik_message_11_90(data);
-    break;
-
-  case OMNIK_MESSAGE_ID(0x11, 0xC3):
-    omnik_message_11_c3(data);
-    break;
-
-  case OMNIK_MESSAGE_ID(0x12, 0xC0):
-    omnik_message_12_c0(data);
-    break;
-
-  case OMNIK_MESSAGE_ID(0x12, 0xC1):
-    omnik_message_12_c1(data);
-    break;
-
-  case OMNIK_MESSAGE_ID(0xFF, 0xFF):
-    omnik_message_no_data(data);
-    break;
+bool OmnikInverter::is_omnik_message_accepted(
+    uint16_t sender_address, uint8_t control_code, uint8_t function_code,
+    omnik_base::BigEndianReader &buffer) {
+  if (serial_number_.empty()) {
+    return OmnikBase::is_omnik_message_accepted(sender_address, control_code,
+                                                function_code, buffer);
+  }
 
-  default:
-    ESP_LOGW(TAG,
-             "Unknown combination: control_code=0x%02x, function_code=0x%02x",
-             control_code, function_code);
-    break;
+  // Find the serial number in the messages that contain it.
+  const MessageLayout *layout =
+      find_message_layout(control_code, function_code, buffer.get_limit());
+  if (layout == nullptr || layout->serial_number_offset == NO_FIELD) {
+    return this->address_.has_value() && *this->address_ == sender_address;
   }
+
+  // (Re)bind the sender address to this inverter in case the serial number
+  // matches, and release it in case the address is now used by another
+  // inverter.
+  buffer.set_position(layout->serial_number_offset);
+  char serial_number[SERIAL_NUMBER_SIZE + 1];
+  omnik_base::read_string(buffer, SERIAL_NUMBER_SIZE, serial_number);
+  if (serial_number_ == serial_number) {
+    if (!this->address_.has_value() || *this->address_ != sender_address) {
+      ESP_LOGI(TAG, "Inverter %s has address 0x%04X", serial_number_.c_str(),
+               sender_address);
+      this->address_ = sender_address;
+    }
+    return true;
+  }
+  if (this->address_.has_value() && *this->address_ == sender_address) {
+    this->address_.reset();
+  }
+  return false;
 }
 
 /**
  * @see the header file.
  */
-void OmnikInverter::omnik_message_10_80(ByteBuffer &buffer) {
-  std::string serial_number = omnik_base::to_string(buffer.get_vector(16));
-  serial_device_number_text_sensor_->publish_state(serial_number);
+void OmnikInverter::omnik_message_10_80(omnik_base::BigEndianReader &buffer) {
+  omnik_base::process_string_message<SERIAL_NUMBER_SIZE>(
+      buffer, ChangedTextState(serial_device_number_text_sensor_));
 }
 
 /**
  * @see the header file.
  */
-void OmnikInverter::omnik_message_10_81(ByteBuffer &buffer) {
-  uint8_t status = buffer.get_uint8();
-  status_10_81_text_sensor_->publish_state(omnik_base::to_hex(status));
+void OmnikInverter::omnik_message_10_81(omnik_base::BigEndianReader &buffer) {
+  omnik_base::process_status_message(
+      buffer, ChangedTextState(status_10_81_text_sensor_));
 }
 
 /**
  * @see the header file.
  */
-void OmnikInverter::omnik_message_10_84(ByteBuffer &buffer) {
-  uint8_t status = buffer.get_uint8();
-  status_10_84_text_sensor_->publish_state(omnik_base::to_hex(status));
+void OmnikInverter::omnik_message_10_84(omnik_base::BigEndianReader &buffer) {
+  omnik_base::process_status_message(
+      buffer, ChangedTextState(status_10_84_text_sensor_));
 }
 
 /**
  * @see the header file.
  */
-void OmnikInverter::omnik_message_11_83(ByteBuffer &buffer) {
-  uint8_t nr_of_phases = buffer.get_uint8();
-  nr_of_phases_text_sensor_->publish_state(std::to_string(nr_of_phases));
-
-  std::string rated_power = omnik_base::to_string(buffer.get_vector(6));
-  rated_power_text_sensor_->publish_state(rated_power);
-
-  std::string country = omnik_base::to_string(buffer.get_vector(2));
-  country_text_sensor_->publish_state(country);
-
-  uint32_t firmware_version_main = buffer.get_uint24();
-  firmware_version_main_text_sensor_->publish_state(
-      to_version(firmware_version_main));
-
-  uint32_t firmware_version_slave = buffer.get_uint32();
-  firmware_version_slave_text_sensor_->publish_state(
-      to_version(firmware_version_slave));
-
-  std::string inverter_model = omnik_base::to_string(buffer.get_vector(12));
-  inverter_model_text_sensor_->publish_state(inverter_model);
-
-  std::string brand = omnik_base::to_string(buffer.get_vector(16));
-  brand_text_sensor_->publish_state(brand);
-
-  std::string serial_number = omnik_base::to_string(buffer.get_vector(16));
-  serial_device_number_text_sensor_->publish_state(serial_number);
-
-  std::string message_11_83_bytes_60_77 =
-      omnik_base::to_string(buffer.get_vector(17));
-  message_11_83_bytes_60_77_text_sensor_->publish_state(
-      message_11_83_bytes_60_77);
+void OmnikInverter::omnik_message_11_83(omnik_base::BigEndianReader &buffer) {
+  // The values are only published in case they have changed, so that a
+  // repeated message doesn't allocate memory.
+  InverterInfoTextStates<ChangedTextState> text_states{
+      ChangedTextState(nr_of_phases_text_sensor_),
+      ChangedTextState(rated_power_text_sensor_),
+      ChangedTextState(country_text_sensor_),
+      ChangedTextState(firmware_version_main_text_sensor_),
+      ChangedTextState(firmware_version_slave_text_sensor_),
+      ChangedTextState(inverter_model_text_sensor_),
+      ChangedTextState(brand_text_sensor_),
+      ChangedTextState(serial_device_number_text_sensor_),
+      ChangedTextState(message_11_83_bytes_60_77_text_sensor_),
+  };
+  uint8_t bytes_60_77[INFO_UNDECODED_SIZE];
+  process_inverter_info(buffer, info_, bytes_60_77, text_states);
+  message_11_83_bytes_60_77_variance_.track(bytes_60_77);
+
+  info_sequence_number_++;
 }
 
 /**
  * @see the header file.
  */
-void OmnikInverter::omnik_message_11_90(ByteBuffer &buffer) {
-  int16_t temperature = buffer.get_int16();
-  temperature_sensor_->publish_state(temperature / 10.0);
-
-  uint16_t pv1_voltage = buffer.get_uint16();
-  pv1_voltage_sensor_->publish_state(pv1_voltage / 10.0);
-
-  uint16_t pv2_voltage = buffer.get_uint16();
-  pv2_voltage_sensor_->publish_state(pv2_voltage / 10.0);
-
-  uint16_t pv3_voltage = buffer.get_uint16();
-  pv3_voltage_sensor_->publish_state(pv3_voltage / 10.0);
-
-  uint16_t pv1_current = buffer.get_uint16();
-  pv1_current_sensor_->publish_state(pv1_current / 10.0);
-
-  uint16_t pv2_current = buffer.get_uint16();
-  pv2_current_sensor_->publish_state(pv2_current / 10.0);
-
-  uint16_t pv3_current = buffer.get_uint16();
-  pv3_current_sensor_->publish_state(pv3_current / 10.0);
-
-  uint16_t r_current = buffer.get_uint16();
-  r_current_sensor_->publish_state(r_current / 10.0);
-
-  uint16_t s_current = buffer.get_uint16();
-  s_current_sensor_->publish_state(s_current / 10.0);
-
-  uint16_t t_current = buffer.get_uint16();
-  t_current_sensor_->publish_state(t_current / 10.0);
-
-  uint16_t r_voltage = buffer.get_uint16();
-  r_voltage_sensor_->publish_state(r_voltage / 10.0);
-
-  uint16_t s_voltage = buffer.get_uint16();
-  s_voltage_sensor_->publish_state(s_voltage / 10.0);
-
-  uint16_t t_voltage = buffer.get_uint16();
-  t_voltage_sensor_->publish_state(t_voltage / 10.0);
-
-  uint16_t r_frequency = buffer.get_uint16();
-  r_frequency_sensor_->publish_state(r_frequency / 100.0);
-
-  uint16_t r_power = buffer.get_uint16();
-  r_power_sensor_->publish_state(r_power / 1000.0);
-
-  uint16_t s_frequency = buffer.get_uint16();
-  s_frequency_sensor_->publish_state(s_frequency / 100.0);
-
-  uint16_t s_power = buffer.get_uint16();
-  s_power_sensor_->publish_state(s_power / 1000.0);
-
-  uint16_t t_frequency = buffer.get_uint16();
-  t_frequency_sensor_->publish_state(t_frequency / 100.0);
-
-  uint16_t t_power = buffer.get_uint16();
-  t_power_sensor_->publish_state(t_power / 1000.0);
-
-  uint16_t energy_today = buffer.get_uint16();
-  energy_today_sensor_->publish_state(energy_today / 100.0);
-
-  uint32_t energy_total = buffer.get_uint32();
-  energy_total_sensor_->publish_state(energy_total / 10.0);
+void OmnikInverter::omnik_message_11_90(omnik_base::BigEndianReader &buffer) {
+  const MessageLayout &layout =
+      *find_message_layout(0x11, 0x90, buffer.get_limit());
+  RealtimeData &data = latest_sample_.data;
+  decode_realtime_data(buffer, data);
+
+  latest_sample_.sequence_number++;
+  latest_sample_.time = millis();
+
+  // An idle inverter keeps sending the same sample without power all night,
+  // so only the first one is published.
+  bool is_waiting = data.run_state == RUN_STATE_WAITING;
+  if (is_idle_) {
+    if (is_waiting) {
+      return;
+    }
+    ESP_LOGI(TAG, "The inverter is running again");
+    is_idle_ = false;
+    stop_power_save();
+  }
 
-  uint32_t hours_total = buffer.get_uint32();
-  hours_total_sensor_->publish_state(hours_total);
+  publish_sample(data);
 
-  uint16_t run_state = buffer.get_uint16();
-  run_state_text_sensor_->publish_state(to_run_state(run_state));
+  // The firmware versions are only published in case they have changed, so
+  // that the message doesn't allocate memory.
+  process_firmware_versions(
+      buffer, layout,
+      ChangedTextState(firmware_version_main_text_sensor_),
+      ChangedTextState(firmware_version_slave_text_sensor_));
 
-  uint16_t grid_voltage_fault_value = buffer.get_uint16();
-  grid_voltage_fault_value_sensor_->publish_state(grid_voltage_fault_value /
-                                                  10.0);
+  if (is_waiting && power_save_timeout_ > 0) {
+    start_idle();
+  }
+}
 
-  uint16_t grid_frequency_fault_value = buffer.get_uint16();
-  grid_frequency_fault_value_sensor_->publish_state(grid_frequency_fault_value /
-                                                    100.0);
+/**
+ * @see the header file.
+ */
+void OmnikInverter::publish_sample(const RealtimeData &data) {
+  if (publish_sensors_) {
+    publish_realtime_data(data);
+  }
+  publish_error_bitmap(data.error_message_binary_index);
+  if (snapshot_text_sensor_ != nullptr) {
+    publish_snapshot(data);
+  }
+  if (history_size_ > 0) {
+    record_history(data);
+  }
+  sample_callback_.call(latest_sample_);
+}
 
-  uint16_t grid_impedance_fault_value = buffer.get_uint16();
-  grid_impedance_fault_value_sensor_->publish_state(grid_impedance_fault_value /
-                                                    1000.0);
+/**
+ * @see the header file.
+ */
+void OmnikInverter::check_idle() {
+  if (is_idle_ || millis() - latest_sample_.time < power_save_timeout_) {
+    return;
+  }
+  // After a boot while the inverter is asleep there is no sample to end, so
+  // nothing is published: the totals of a made up sample would be 0.
+  if (!has_realtime_data()) {
+    start_idle();
+    return;
+  }
+  // The final sample is published like a received one, so that the snapshot,
+  // the history and the sample callbacks also see it.
+  latest_sample_.data = to_idle_data(latest_sample_.data);
+  latest_sample_.sequence_number++;
+  latest_sample_.time = millis();
+  publish_sample(latest_sample_.data);
+  start_idle();
+}
 
-  uint16_t temperature_fault = buffer.get_uint16();
-  temperature_fault_sensor_->publish_state(temperature_fault / 10.0);
+/**
+ * @see the header file.
+ */
+void OmnikInverter::start_idle() {
+  ESP_LOGI(TAG, "The inverter is idle");
+  is_idle_ = true;
+  start_power_save();
+}
 
-  uint16_t pv_voltage_fault = buffer.get_uint16();
-  pv_voltage_fault_sensor_->publish_state(pv_voltage_fault / 10.0);
+/**
+ * @see the header file.
+ */
+void OmnikInverter::publish_realtime_data(const RealtimeData &data) {
+  // The values are staged and published in the next loop iterations. A value
+  // that hasn't been published yet is overwritten by the newer one.
+  for (uint8_t i = 0; i < NR_OF_REALTIME_FIELDS; i++) {
+    RealtimeField field = (RealtimeField) i;
+    if (realtime_sensors_[field] != nullptr) {
+      publish_scheduler_.stage(
+          field, scale_realtime_field(field, get_realtime_field(data, field)));
+    }
+  }
+  publish_scheduler_.stage(run_state_slot_,
+                           to_run_state(data.run_state).c_str());
+  enable_loop();
+}
 
-  uint16_t gfci_current_fault = buffer.get_uint16();
-  gfci_current_fault_sensor_->publish_state(gfci_current_fault / 1000.0);
+/**
+ * @see the header file.
+ */
+void OmnikInverter::publish_error_bitmap(uint32_t error_bitmap) {
+  if (is_error_bitmap_published_ && error_bitmap == published_error_bitmap_) {
+    return;
+  }
+  is_error_bitmap_published_ = true;
+  published_error_bitmap_ = error_bitmap;
+
+  // The fault binary sensors are configured one by one, so they are also
+  // published when the individual sensors aren't.
+  if (publish_sensors_ && error_message_binary_index_text_sensor_ != nullptr) {
+    error_message_binary_index_text_sensor_->publish_state(
+        std::bitset<32>(error_bitmap).to_string());
+  }
+  for (const FaultBinarySensor &fault : fault_binary_sensors_) {
+    fault.binary_sensor->publish_state((error_bitmap >> fault.bit) & 1);
+  }
+}
 
-  uint32_t error_message_binary_index = buffer.get_uint32();
-  error_message_binary_index_text_sensor_->publish_state(
-      std::bitset<32>(error_message_binary_index).to_string());
+/**
+ * @see the header file.
+ */
+void OmnikInverter::publish_snapshot(const RealtimeData &data) {
+  // The field names don't fit in a state of Home Assistant, so the scaled
+  // values are an array in the order of RealtimeField, after the sequence
+  // number.
+  char buffer[MAX_SNAPSHOT_LENGTH + 1];
+  int length = snprintf(buffer, sizeof(buffer), "[%" PRIu32,
+                        latest_sample_.sequence_number);
+  for (uint8_t i = 0; i < NR_OF_REALTIME_FIELDS; i++) {
+    if (length < 0 || (size_t) length >= sizeof(buffer)) {
+      break;
+    }
+    buffer[length++] = ',';
+    RealtimeField field = (RealtimeField) i;
+    length += format_realtime_field(field, get_realtime_field(data, field),
+                                    buffer + length, sizeof(buffer) - length);
+  }
+  if (length >= 0 && (size_t) length < sizeof(buffer)) {
+    length += snprintf(buffer + length, sizeof(buffer) - length, "]");
+  }
+  if (length < 0 || (size_t) length >= sizeof(buffer)) {
+    ESP_LOGW(TAG, "Snapshot is longer than %zu characters",
+             MAX_SNAPSHOT_LENGTH);
+    return;
+  }
+  snapshot_text_sensor_->publish_state(buffer);
+}
 
-  std::string main_firmware_version =
-      omnik_base::to_string(buffer.get_vector(20));
-  if (!main_firmware_version.empty() && main_firmware_version[0] != '\0') {
-    firmware_version_main_text_sensor_->publish_state(main_firmware_version);
+/**
+ * @see the header file.
+ */
+void OmnikInverter::record_history(const RealtimeData &data) {
+  uint32_t now = millis() / 1000;
+  if (history_.get_nr_of_samples() > 0 &&
+      now - last_history_time_ < history_interval_) {
+    return;
   }
+  last_history_time_ = now;
 
-  std::string slave_firmware_version =
-      omnik_base::to_string(buffer.get_vector(20));
-  if (!slave_firmware_version.empty() && slave_firmware_version[0] != '\0') {
-    firmware_version_slave_text_sensor_->publish_state(slave_firmware_version);
+  int32_t values[omnik_base::DeltaHistory::MAX_VALUES];
+  for (size_t i = 0; i < history_.get_nr_of_values(); i++) {
+    values[i] = get_realtime_field(data, history_fields_[i]);
   }
+  history_.append(now, values);
 }
 
 /**
  * @see the header file.
  */
-void OmnikInverter::omnik_message_11_c3(ByteBuffer &buffer) {
+void OmnikInverter::omnik_message_11_c3(omnik_base::BigEndianReader &buffer) {
   uint8_t nr_of_alarms = buffer.get_uint8();
   nr_of_alarms_sensor_->publish_state(nr_of_alarms);
 }
@@ -376,17 +420,17 @@ void OmnikInverter::omnik_message_11_c3(ByteBuffer &buffer) {
 /**
  * @see the header file.
  */
-void OmnikInverter::omnik_message_12_c0(ByteBuffer &buffer) {
-  uint8_t status = buffer.get_uint8();
-  status_12_c0_text_sensor_->publish_state(omnik_base::to_hex(status));
+void OmnikInverter::omnik_message_12_c0(omnik_base::BigEndianReader &buffer) {
+  omnik_base::process_status_message(
+      buffer, ChangedTextState(status_12_c0_text_sensor_));
 }
 
 /**
  * @see the header file.
  */
-void OmnikInverter::omnik_message_12_c1(ByteBuffer &buffer) {
-  uint8_t status = buffer.get_uint8();
-  status_12_c1_text_sensor_->publish_state(omnik_base::to_hex(status));
+void OmnikInverter::omnik_message_12_c1(omnik_base::BigEndianReader &buffer) {
+  omnik_base::process_status_message(
+      buffer, ChangedTextState(status_12_c1_text_sensor_));
 }
 
 } // namespace omnik_inverter
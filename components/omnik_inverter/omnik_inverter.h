@@ -1,23 +1,221 @@
 #pragma once
 
+#include "esphome/components/binary_sensor/binary_sensor.h"
 #include "esphome/components/omnik_base/omnik_base.h"
+#include "esphome/components/omnik_base/omnik_device.h"
+#include "esphome/components/omnik_base/omnik_history.h"
+#include "omnik_inverter_info.h"
+#include "omnik_message_layout.h"
+#include "omnik_realtime_data.h"
 #include "esphome/components/sensor/sensor.h"
 #include "esphome/components/text_sensor/text_sensor.h"
+#include "esphome/core/automation.h"
+#include "esphome/core/helpers.h"
 
 namespace esphome {
 namespace omnik_inverter {
 
+/**
+ * One complete 0x11/0x90 message: the raw values, with the time at which it
+ * was received. It is a plain struct, so a consumer can copy it to keep a
+ * consistent set of values.
+ */
+struct RealtimeSample {
+  // The sequence number of the message (1 for the first message, 0 in case
+  // no message has been received).
+  uint32_t sequence_number;
+  // The time at which the message was received (in milliseconds).
+  uint32_t time;
+  // The raw values of the message.
+  RealtimeData data;
+};
+
 /**
  * This class is responsible for processing the messages received from the Omnik
  * inverter.
  */
-class OmnikInverter : public omnik_base::OmnikBase {
+class OmnikInverter : public omnik_base::OmnikDevice<OmnikInverter> {
 public:
+  // Tag that is used for log messages.
+  static constexpr const char *const LOG_TAG = "omnik_inverter";
+
+  /**
+   * Allocate the memory of the history and start the receive task.
+   */
+  void setup() override;
+
   /**
    * Log the current configuration.
    */
   void dump_config() override;
 
+  /**
+   * Only accept the messages of the inverter with this serial number.
+   *
+   * The sender address of the inverter is learned from the messages that
+   * contain the serial number.
+   *
+   * @param serial_number The serial number of the inverter.
+   */
+  void set_serial_number(const std::string &serial_number) {
+    this->serial_number_ = serial_number;
+  }
+
+  /**
+   * Publish the values of the 0x11/0x90 message to the individual sensors.
+   *
+   * @param publish_sensors False in case only the snapshot, the history and
+   *                        the fault binary sensors are published.
+   */
+  void set_publish_sensors(bool publish_sensors) {
+    this->publish_sensors_ = publish_sensors;
+  }
+
+  /**
+   * Set the sensor to which the value of a field of the 0x11/0x90 message is
+   * published. The run state and the error message binary index are
+   * published to text sensors instead.
+   *
+   * @param field The field.
+   * @param sensor The sensor.
+   */
+  void set_realtime_sensor(RealtimeField field, sensor::Sensor *sensor) {
+    this->realtime_sensors_[field] = sensor;
+  }
+
+  /**
+   * Get the sensor of a field of the 0x11/0x90 message (nullptr in case there
+   * is none).
+   */
+  sensor::Sensor *get_realtime_sensor(RealtimeField field) const {
+    return this->realtime_sensors_[field];
+  }
+
+  /**
+   * Check whether a 0x11/0x90 message has been received.
+   */
+  bool has_realtime_data() const {
+    return this->latest_sample_.sequence_number > 0;
+  }
+
+  /**
+   * Get the sequence number of the last received 0x11/0x90 message (0 in case
+   * none has been received).
+   */
+  uint32_t get_realtime_sequence_number() const {
+    return this->latest_sample_.sequence_number;
+  }
+
+  /**
+   * Get the values of the last received 0x11/0x90 message.
+   */
+  const RealtimeData &get_realtime_data() const {
+    return this->latest_sample_.data;
+  }
+
+  /**
+   * Get the last received 0x11/0x90 message, with its sequence number and
+   * the time at which it was received.
+   */
+  const RealtimeSample &get_latest_sample() const {
+    return this->latest_sample_;
+  }
+
+  /**
+   * Add a callback that is called with every sample that is published (an
+   * idle inverter only publishes its first sample).
+   *
+   * @param callback The callback. The sample is only valid during the call.
+   */
+  void add_on_sample_callback(
+      std::function<void(const RealtimeSample &)> &&callback) {
+    this->sample_callback_.add(std::move(callback));
+  }
+
+  /**
+   * Check whether a 0x11/0x83 message has been received.
+   */
+  bool has_info() const { return this->info_sequence_number_ > 0; }
+
+  /**
+   * Get the sequence number of the last received 0x11/0x83 message (0 in case
+   * none has been received).
+   */
+  uint32_t get_info_sequence_number() const {
+    return this->info_sequence_number_;
+  }
+
+  /**
+   * Get the values of the last received 0x11/0x83 message.
+   */
+  const InverterInfo &get_info() const { return this->info_; }
+
+  /**
+   * Keep a history of the values of the 0x11/0x90 messages.
+   *
+   * @param size The size of the history (in bytes).
+   * @param interval The minimum interval between two samples (in seconds).
+   */
+  void set_history(size_t size, uint32_t interval) {
+    this->history_size_ = size;
+    this->history_interval_ = interval;
+  }
+
+  /**
+   * Add a field to the samples of the history.
+   */
+  void add_history_field(RealtimeField field) {
+    this->history_fields_.push_back(field);
+  }
+
+  /**
+   * Get the history. The timestamps are in seconds since boot.
+   */
+  const omnik_base::DeltaHistory &get_history() const {
+    return this->history_;
+  }
+
+  /**
+   * Get the fields of the samples of the history.
+   */
+  const std::vector<RealtimeField> &get_history_fields() const {
+    return this->history_fields_;
+  }
+
+  /**
+   * Save power while the inverter is asleep for the night.
+   *
+   * The inverter is idle when it reports the Waiting run state, or when no
+   * 0x11/0x90 message has been received for the timeout. Then one final
+   * sample without power is published (but only in case a sample has been
+   * received since the boot), the next samples are only published once the
+   * inverter runs again, and the idle loop is woken up at a slow interval
+   * until then (see OmnikBase::start_power_save()).
+   *
+   * @param timeout The time without a 0x11/0x90 message after which the
+   *                inverter is idle (in milliseconds).
+   */
+  void set_power_save(uint32_t timeout) {
+    this->power_save_timeout_ = timeout;
+  }
+
+  /**
+   * Check whether the inverter is idle (asleep for the night).
+   */
+  bool is_idle() const { return this->is_idle_; }
+
+  /**
+   * Add a binary sensor with the state of a bit of the error bitmap (the
+   * error message binary index of the 0x11/0x90 message).
+   *
+   * @param bit The bit (0 .. 31).
+   * @param binary_sensor The binary sensor.
+   */
+  void add_fault_binary_sensor(uint8_t bit,
+                               binary_sensor::BinarySensor *binary_sensor) {
+    this->fault_binary_sensors_.push_back({bit, binary_sensor});
+  }
+
   // Omnik 0x10/0x80 message.
   SUB_TEXT_SENSOR(serial_device_number)
   // Omnik 0x10/0x81 message.
@@ -33,37 +231,14 @@ public:
   SUB_TEXT_SENSOR(inverter_model)
   SUB_TEXT_SENSOR(brand)
   SUB_TEXT_SENSOR(message_11_83_bytes_60_77)
-  // Omnik 0x11/0x90 message.
-  SUB_SENSOR(temperature)
-  SUB_SENSOR(pv1_voltage)
-  SUB_SENSOR(pv2_voltage)
-  SUB_SENSOR(pv3_voltage)
-  SUB_SENSOR(pv1_current)
-  SUB_SENSOR(pv2_current)
-  SUB_SENSOR(pv3_current)
-  SUB_SENSOR(r_current)
-  SUB_SENSOR(s_current)
-  SUB_SENSOR(t_current)
-  SUB_SENSOR(r_voltage)
-  SUB_SENSOR(s_voltage)
-  SUB_SENSOR(t_voltage)
-  SUB_SENSOR(r_frequency)
-  SUB_SENSOR(r_power)
-  SUB_SENSOR(s_frequency)
-  SUB_SENSOR(s_power)
-  SUB_SENSOR(t_frequency)
-  SUB_SENSOR(t_power)
-  SUB_SENSOR(energy_today)
-  SUB_SENSOR(energy_total)
-  SUB_SENSOR(hours_total)
+  // Omnik 0x11/0x90 message (the other values are published to the realtime
+  // sensors).
   SUB_TEXT_SENSOR(run_state)
-  SUB_SENSOR(grid_voltage_fault_value)
-  SUB_SENSOR(grid_frequency_fault_value)
-  SUB_SENSOR(grid_impedance_fault_value)
-  SUB_SENSOR(temperature_fault)
-  SUB_SENSOR(pv_voltage_fault)
-  SUB_SENSOR(gfci_current_fault)
   SUB_TEXT_SENSOR(error_message_binary_index)
+  // All the raw values of one Omnik 0x11/0x90 message in one JSON object,
+  // named after REALTIME_FIELDS and without the fields with a value of 0:
+  // {"seq":<sequence number>,"temperature":<value>,...}
+  SUB_TEXT_SENSOR(snapshot)
   // SUB_TEXT_SENSOR(main_firmware_version)
   // SUB_TEXT_SENSOR(slave_firmware_version)
   // Omnik 0x11/0xC3 message.
@@ -75,21 +250,86 @@ public:
 
 protected:
   /**
-   * process an Omnik message.
+   * Check whether a message should be processed by this inverter.
    *
    * See omnik_base::OmnikBase for a full description.
    */
-  void process_omnik_message(uint8_t control_code, uint8_t function_code,
-                             ByteBuffer &buffer) override;
+  bool is_omnik_message_accepted(uint16_t sender_address, uint8_t control_code,
+                                 uint8_t function_code,
+                                 omnik_base::BigEndianReader &buffer) override;
 
 private:
+  friend class omnik_base::OmnikDevice<OmnikInverter>;
+
   /**
-   * Process an Omnik message that contains no data.
-   *
-   * @param buffer The data of the message.
-   *               (no data)
+   * A sensor or text sensor of the inverter.
+   */
+  struct SensorEntry {
+    // The name of the sensor.
+    const char *name;
+    // The sensor (nullptr in case it is a text sensor).
+    sensor::Sensor *OmnikInverter::*sensor;
+    // The text sensor (nullptr in case it is a sensor).
+    text_sensor::TextSensor *OmnikInverter::*text_sensor;
+  };
+
+  /**
+   * A binary sensor with the state of a bit of the error bitmap.
    */
-  void omnik_message_no_data(ByteBuffer &buffer) {}
+  struct FaultBinarySensor {
+    // The bit.
+    uint8_t bit;
+    // The binary sensor.
+    binary_sensor::BinarySensor *binary_sensor;
+  };
+
+  // The sensors and text sensors of the inverter, except the realtime
+  // sensors.
+  static const SensorEntry SENSORS[];
+
+  // The serial number of the inverter from which the messages are accepted
+  // (all inverters in case it is empty).
+  std::string serial_number_;
+  // Publish the values of the 0x11/0x90 message to the individual sensors.
+  bool publish_sensors_{true};
+  // The sensors with the values of the fields of RealtimeData (nullptr for
+  // the fields without a sensor).
+  sensor::Sensor *realtime_sensors_[NR_OF_REALTIME_FIELDS]{};
+  // The last received 0x11/0x90 message.
+  RealtimeSample latest_sample_{};
+  // The callbacks that are called with every published sample.
+  CallbackManager<void(const RealtimeSample &)> sample_callback_;
+  // The time without a 0x11/0x90 message after which the inverter is idle (in
+  // milliseconds, 0 in case there is no power save).
+  uint32_t power_save_timeout_{0};
+  // True in case the inverter is idle (asleep for the night).
+  bool is_idle_{false};
+  // The slot of the run state in the publish scheduler (the slot of a
+  // realtime sensor is its RealtimeField).
+  size_t run_state_slot_{0};
+  // The binary sensors with the states of the bits of the error bitmap.
+  std::vector<FaultBinarySensor> fault_binary_sensors_;
+  // True in case the error bitmap has been published.
+  bool is_error_bitmap_published_{false};
+  // The error bitmap that has been published.
+  uint32_t published_error_bitmap_{0};
+  // The size of the history (0 in case there is no history).
+  size_t history_size_{0};
+  // The minimum interval between two samples of the history (in seconds).
+  uint32_t history_interval_{60};
+  // The fields of the samples of the history.
+  std::vector<RealtimeField> history_fields_;
+  // The history of the 0x11/0x90 messages.
+  omnik_base::DeltaHistory history_;
+  // The time of the last sample of the history (in seconds).
+  uint32_t last_history_time_{0};
+  // The sequence number of the last received 0x11/0x83 message.
+  uint32_t info_sequence_number_{0};
+  // The values of the last received 0x11/0x83 message.
+  InverterInfo info_;
+  // The changes of the bytes of the 0x11/0x83 message that aren't decoded.
+  omnik_base::ByteVariance<INFO_UNDECODED_SIZE>
+      message_11_83_bytes_60_77_variance_;
 
   /**
    * Process an Omnik 0x10/0x80 message.
@@ -97,7 +337,7 @@ private:
    * @param buffer The data of the message.
    * 		   data[0-15]: Inverter serial number
    */
-  void omnik_message_10_80(ByteBuffer &buffer);
+  void omnik_message_10_80(omnik_base::BigEndianReader &buffer);
 
   /**
    * Process an Omnik 0x10/0x81 message.
@@ -105,7 +345,7 @@ private:
    * @param buffer The data of the message.
    * 		   data[0]: Ok (0x06)
    */
-  void omnik_message_10_81(ByteBuffer &buffer);
+  void omnik_message_10_81(omnik_base::BigEndianReader &buffer);
 
   /**
    * Process an Omnik 0x10/0x84 message.
@@ -113,7 +353,7 @@ private:
    * @param buffer The data of the message.
    * 		   data[0]: Ok (0x06)
    */
-  void omnik_message_10_84(ByteBuffer &buffer);
+  void omnik_message_10_84(omnik_base::BigEndianReader &buffer);
 
   /**
    * Process an Omnik 0x11/0x83 message.
@@ -127,7 +367,7 @@ private:
    *               data[44-59]: Inverter serial number
    *               data[60-76]: ??
    */
-  void omnik_message_11_83(ByteBuffer &buffer);
+  void omnik_message_11_83(omnik_base::BigEndianReader &buffer);
 
   /**
    * Process an Omnik 0x11/0x90 message.
@@ -165,8 +405,65 @@ private:
    *               data[62-65]: Error message binary index
    *               data[66-85]: Inverter main firmware version
    *               data[86-105]: Inverter slave firmware version
+   *               The firmware versions are only present in the data of
+   *               some firmware generations (see MessageLayout).
+   */
+  void omnik_message_11_90(omnik_base::BigEndianReader &buffer);
+
+  /**
+   * Publish the values of an Omnik 0x11/0x90 message to the individual
+   * sensors, the fault binary sensors, the snapshot, the history and the
+   * sample callbacks.
+   *
+   * @param data The values of the message.
    */
-  void omnik_message_11_90(ByteBuffer &buffer);
+  void publish_sample(const RealtimeData &data);
+
+  /**
+   * Check whether no 0x11/0x90 message has been received for the power save
+   * timeout, and if so make the inverter idle. A final sample is only
+   * published in case a 0x11/0x90 message has been received at all.
+   */
+  void check_idle();
+
+  /**
+   * Make the inverter idle: the samples aren't published and the idle loop is
+   * woken up at a slow interval.
+   */
+  void start_idle();
+
+  /**
+   * Stage the values of an Omnik 0x11/0x90 message for the individual
+   * sensors in the publish scheduler.
+   *
+   * @param data The values of the message.
+   */
+  void publish_realtime_data(const RealtimeData &data);
+
+  /**
+   * Publish the error bitmap, but only in case it has changed.
+   *
+   * @param error_bitmap The error bitmap.
+   */
+  void publish_error_bitmap(uint32_t error_bitmap);
+
+  /**
+   * Publish the values of an Omnik 0x11/0x90 message as one snapshot: a JSON
+   * array with the sequence number and the scaled values of all the fields
+   * (in the order of RealtimeField). A snapshot that is longer than a state
+   * of Home Assistant (255 characters) isn't published.
+   *
+   * @param data The values of the message.
+   */
+  void publish_snapshot(const RealtimeData &data);
+
+  /**
+   * Add the values of an Omnik 0x11/0x90 message to the history, in case the
+   * interval has passed.
+   *
+   * @param data The values of the message.
+   */
+  void record_history(const RealtimeData &data);
 
   /**
    * Process an Omnik 0x11/0xC3 message.
@@ -174,7 +471,7 @@ private:
    * @param buffer The data of the message.
    *               data[0]: Number of alarms.
    */
-  void omnik_message_11_c3(ByteBuffer &buffer);
+  void omnik_message_11_c3(omnik_base::BigEndianReader &buffer);
 
   /**
    * Process an Omnik 0x12/0xC0 message.
@@ -182,7 +479,7 @@ private:
    * @param buffer The data of the message.
    * 		   data[0]: Ok (0x06)
    */
-  void omnik_message_12_c0(ByteBuffer &buffer);
+  void omnik_message_12_c0(omnik_base::BigEndianReader &buffer);
 
   /**
    * Process an Omnik 0x12/0xC1 message.
@@ -190,7 +487,37 @@ private:
    * @param buffer The data of the message.
    * 		   data[0]: Ok (0x06)
    */
-  void omnik_message_12_c1(ByteBuffer &buffer);
+  void omnik_message_12_c1(omnik_base::BigEndianReader &buffer);
+
+  // The handlers of the messages, sorted by message id, with the data sizes
+  // of the known layouts
+  // (the layouts of the messages with fields at an offset are in
+  // omnik_message_layout.cpp).
+  static constexpr MessageHandler MESSAGE_HANDLERS[] = {
+      {OMNIK_MESSAGE_ID(0x10, 0x80), 16, &OmnikInverter::omnik_message_10_80},
+      {OMNIK_MESSAGE_ID(0x10, 0x81), 1, &OmnikInverter::omnik_message_10_81},
+      {OMNIK_MESSAGE_ID(0x10, 0x84), 1, &OmnikInverter::omnik_message_10_84},
+      {OMNIK_MESSAGE_ID(0x11, 0x83), INVERTER_INFO_SIZE,
+       &OmnikInverter::omnik_message_11_83},
+      {OMNIK_MESSAGE_ID(0x11, 0x90), 66, &OmnikInverter::omnik_message_11_90},
+      {OMNIK_MESSAGE_ID(0x11, 0x90), 106, &OmnikInverter::omnik_message_11_90},
+      {OMNIK_MESSAGE_ID(0x11, 0xC3), 1, &OmnikInverter::omnik_message_11_c3},
+      {OMNIK_MESSAGE_ID(0x12, 0xC0), 1, &OmnikInverter::omnik_message_12_c0},
+      {OMNIK_MESSAGE_ID(0x12, 0xC1), 1, &OmnikInverter::omnik_message_12_c1},
+      {OMNIK_MESSAGE_ID(0xFF, 0xFF), omnik_base::ANY_DATA_SIZE,
+       &OmnikInverter::omnik_message_no_data},
+  };
+};
+
+/**
+ * Triggers an automation with every published sample of an inverter.
+ */
+class SampleTrigger : public Trigger<RealtimeSample> {
+public:
+  explicit SampleTrigger(OmnikInverter *inverter) {
+    inverter->add_on_sample_callback(
+        [this](const RealtimeSample &sample) { this->trigger(sample); });
+  }
 };
 
 } // namespace omnik_inverter
@@ -0,0 +1,22 @@
+#include "omnik_inverter_info.h"
+
+#include <cstdio>
+
+namespace esphome {
+namespace omnik_inverter {
+
+/**
+ * @see the header file.
+ */
+void to_version(uint32_t version, char text[], size_t size) {
+  unsigned int build = version % 10000;
+  version /= 10000;
+  unsigned int minor = version % 100;
+  version /= 100;
+  unsigned int major = version;
+
+  snprintf(text, size, "V%d.%02dBuild%d", major, minor, build);
+}
+
+} // namespace omnik_inverter
+} // namespace esphome
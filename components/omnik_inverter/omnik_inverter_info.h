@@ -0,0 +1,135 @@
+#pragma once
+
+#include "../omnik_base/omnik_text.h"
+#include "omnik_message_layout.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// This file doesn't depend on ESPHome, so that it can also be used by the
+// host tools.
+
+namespace esphome {
+namespace omnik_inverter {
+
+/**
+ * The values of an Omnik 0x11/0x83 message.
+ */
+struct InverterInfo {
+  uint8_t nr_of_phases;
+  std::string rated_power;
+  std::string country;
+  std::string firmware_version_main;
+  std::string firmware_version_slave;
+  std::string inverter_model;
+  std::string brand;
+  std::string serial_number;
+};
+
+// The number of bytes at the end of the 0x11/0x83 message that aren't
+// decoded (bytes 60-76).
+static const size_t INFO_UNDECODED_SIZE = 17;
+// The data size of the 0x11/0x83 message.
+static const uint16_t INVERTER_INFO_SIZE = 77;
+// The size of the text of a version (with the NUL).
+static const size_t VERSION_TEXT_SIZE = 32;
+
+/**
+ * Convert an integer value to a version string.
+ *
+ * @param version The integer value.
+ * @param text The version string.
+ * @param size The size of the text.
+ */
+void to_version(uint32_t version, char text[], size_t size);
+
+/**
+ * Decode the values of an Omnik 0x11/0x83 message.
+ *
+ * The strings are converted in a buffer on the stack and assigned to the
+ * strings of the info, which keep their capacity. So a repeated message
+ * doesn't allocate memory.
+ *
+ * This is a template on the reader, like the message handlers that use it.
+ *
+ * @param reader The reader of the data of the message.
+ * @param info The decoded values.
+ * @param undecoded The bytes that aren't decoded (INFO_UNDECODED_SIZE).
+ */
+template <typename Reader>
+void decode_inverter_info(Reader &reader, InverterInfo &info,
+                          uint8_t undecoded[]) {
+  char text[VERSION_TEXT_SIZE];
+
+  info.nr_of_phases = reader.get_uint8();
+  omnik_base::read_string(reader, 6, text);
+  info.rated_power = text;
+  omnik_base::read_string(reader, 2, text);
+  info.country = text;
+  to_version(reader.get_uint24(), text, sizeof(text));
+  info.firmware_version_main = text;
+  to_version(reader.get_uint32(), text, sizeof(text));
+  info.firmware_version_slave = text;
+  omnik_base::read_string(reader, 12, text);
+  info.inverter_model = text;
+  omnik_base::read_string(reader, 16, text);
+  info.brand = text;
+  omnik_base::read_string(reader, SERIAL_NUMBER_SIZE, text);
+  info.serial_number = text;
+  for (size_t i = 0; i < INFO_UNDECODED_SIZE; i++) {
+    undecoded[i] = reader.get_uint8();
+  }
+}
+
+/**
+ * The text states of the values of an Omnik 0x11/0x83 message (see
+ * omnik_base::process_status_message()).
+ */
+template <typename TextState> struct InverterInfoTextStates {
+  TextState nr_of_phases;
+  TextState rated_power;
+  TextState country;
+  TextState firmware_version_main;
+  TextState firmware_version_slave;
+  TextState inverter_model;
+  TextState brand;
+  TextState serial_number;
+  // The bytes that aren't decoded.
+  TextState undecoded;
+};
+
+/**
+ * Process an Omnik 0x11/0x83 message: the values are decoded and published to
+ * the text states.
+ *
+ * @param reader The reader of the data of the message.
+ * @param info The decoded values.
+ * @param undecoded The bytes that aren't decoded (INFO_UNDECODED_SIZE).
+ * @param text_states The text states of the values.
+ */
+template <typename Reader, typename TextState>
+void process_inverter_info(Reader &reader, InverterInfo &info,
+                           uint8_t undecoded[],
+                           InverterInfoTextStates<TextState> &text_states) {
+  decode_inverter_info(reader, info, undecoded);
+
+  char text[INFO_UNDECODED_SIZE + 1];
+  snprintf(text, sizeof(text), "%u", info.nr_of_phases);
+  text_states.nr_of_phases.publish(text);
+  text_states.rated_power.publish(info.rated_power.c_str());
+  text_states.country.publish(info.country.c_str());
+  text_states.firmware_version_main.publish(
+      info.firmware_version_main.c_str());
+  text_states.firmware_version_slave.publish(
+      info.firmware_version_slave.c_str());
+  text_states.inverter_model.publish(info.inverter_model.c_str());
+  text_states.brand.publish(info.brand.c_str());
+  text_states.serial_number.publish(info.serial_number.c_str());
+  omnik_base::to_string(undecoded, INFO_UNDECODED_SIZE, text);
+  text_states.undecoded.publish(text);
+}
+
+} // namespace omnik_inverter
+} // namespace esphome
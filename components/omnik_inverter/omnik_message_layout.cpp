@@ -0,0 +1,34 @@
+#include "omnik_message_layout.h"
+
+namespace esphome {
+namespace omnik_inverter {
+
+// The known layouts of the messages with a serial number or firmware
+// versions (the data sizes of the message handlers of OmnikInverter).
+static const MessageLayout MESSAGE_LAYOUTS[] = {
+    {0x10, 0x80, 16, 0, NO_FIELD, NO_FIELD},
+    {0x11, 0x83, 77, 44, NO_FIELD, NO_FIELD},
+    // Without the firmware versions.
+    {0x11, 0x90, 66, NO_FIELD, NO_FIELD, NO_FIELD},
+    // With the firmware versions.
+    {0x11, 0x90, 106, NO_FIELD, 66, 86},
+};
+
+/**
+ * @see the header file.
+ */
+const MessageLayout *find_message_layout(uint8_t control_code,
+                                         uint8_t function_code,
+                                         size_t data_size) {
+  for (const MessageLayout &layout : MESSAGE_LAYOUTS) {
+    if (layout.control_code == control_code &&
+        layout.function_code == function_code &&
+        layout.data_size == data_size) {
+      return &layout;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace omnik_inverter
+} // namespace esphome
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// This file doesn't depend on ESPHome, so that it can also be used by the
+// host tools.
+
+namespace esphome {
+namespace omnik_inverter {
+
+// The offset of a field that isn't part of a layout.
+static const uint8_t NO_FIELD = 0xFF;
+
+/**
+ * The layout of the data of an Omnik message with a specific size.
+ *
+ * Different firmware generations of the inverters send the same message with
+ * a different size, e.g. the 0x11/0x90 message with or without the firmware
+ * versions. The layout is selected once per message, so that the decoder only
+ * reads the fields that are present.
+ */
+struct MessageLayout {
+  // The control code of the message.
+  uint8_t control_code;
+  // The function code of the message.
+  uint8_t function_code;
+  // The size of the data of the message.
+  uint8_t data_size;
+  // The offset of the serial number (NO_FIELD in case there is none).
+  uint8_t serial_number_offset;
+  // The offset of the main firmware version (NO_FIELD in case there is none).
+  uint8_t main_firmware_version_offset;
+  // The offset of the slave firmware version (NO_FIELD in case there is
+  // none).
+  uint8_t slave_firmware_version_offset;
+};
+
+// The size of the serial number.
+static const size_t SERIAL_NUMBER_SIZE = 16;
+// The size of a firmware version.
+static const size_t FIRMWARE_VERSION_SIZE = 20;
+
+/**
+ * Find the layout of a message.
+ *
+ * @param control_code The control code of the message.
+ * @param function_code The function code of the message.
+ * @param data_size The size of the data of the message.
+ * @return The layout, or nullptr in case the message or its size is unknown.
+ */
+const MessageLayout *find_message_layout(uint8_t control_code,
+                                         uint8_t function_code,
+                                         size_t data_size);
+
+} // namespace omnik_inverter
+} // namespace esphome
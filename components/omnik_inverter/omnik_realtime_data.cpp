@@ -0,0 +1,125 @@
+#include "omnik_realtime_data.h"
+#include <cinttypes>
+#include <cstdio>
+
+namespace esphome {
+namespace omnik_inverter {
+
+// The divisors to scale a raw value with a number of decimals.
+static const float DIVISORS[] = {1.0f, 10.0f, 100.0f, 1000.0f};
+// The integer divisors to format a raw value with a number of decimals.
+static const uint32_t INTEGER_DIVISORS[] = {1, 10, 100, 1000};
+
+/**
+ * @see the header file.
+ */
+const char *get_realtime_field_name(RealtimeField field) {
+  return REALTIME_FIELDS[field].name;
+}
+
+/**
+ * @see the header file.
+ */
+uint8_t get_realtime_field_decimals(RealtimeField field) {
+  return REALTIME_FIELDS[field].decimals;
+}
+
+/**
+ * @see the header file.
+ */
+int32_t get_realtime_field(const RealtimeData &data, RealtimeField field) {
+  switch (field) {
+  case REALTIME_FIELD_TEMPERATURE:
+    return data.temperature;
+  case REALTIME_FIELD_PV1_VOLTAGE:
+    return data.pv1_voltage;
+  case REALTIME_FIELD_PV2_VOLTAGE:
+    return data.pv2_voltage;
+  case REALTIME_FIELD_PV3_VOLTAGE:
+    return data.pv3_voltage;
+  case REALTIME_FIELD_PV1_CURRENT:
+    return data.pv1_current;
+  case REALTIME_FIELD_PV2_CURRENT:
+    return data.pv2_current;
+  case REALTIME_FIELD_PV3_CURRENT:
+    return data.pv3_current;
+  case REALTIME_FIELD_R_CURRENT:
+    return data.r_current;
+  case REALTIME_FIELD_S_CURRENT:
+    return data.s_current;
+  case REALTIME_FIELD_T_CURRENT:
+    return data.t_current;
+  case REALTIME_FIELD_R_VOLTAGE:
+    return data.r_voltage;
+  case REALTIME_FIELD_S_VOLTAGE:
+    return data.s_voltage;
+  case REALTIME_FIELD_T_VOLTAGE:
+    return data.t_voltage;
+  case REALTIME_FIELD_R_FREQUENCY:
+    return data.r_frequency;
+  case REALTIME_FIELD_R_POWER:
+    return data.r_power;
+  case REALTIME_FIELD_S_FREQUENCY:
+    return data.s_frequency;
+  case REALTIME_FIELD_S_POWER:
+    return data.s_power;
+  case REALTIME_FIELD_T_FREQUENCY:
+    return data.t_frequency;
+  case REALTIME_FIELD_T_POWER:
+    return data.t_power;
+  case REALTIME_FIELD_ENERGY_TODAY:
+    return data.energy_today;
+  case REALTIME_FIELD_ENERGY_TOTAL:
+    return data.energy_total;
+  case REALTIME_FIELD_HOURS_TOTAL:
+    return data.hours_total;
+  case REALTIME_FIELD_RUN_STATE:
+    return data.run_state;
+  case REALTIME_FIELD_GRID_VOLTAGE_FAULT_VALUE:
+    return data.grid_voltage_fault_value;
+  case REALTIME_FIELD_GRID_FREQUENCY_FAULT_VALUE:
+    return data.grid_frequency_fault_value;
+  case REALTIME_FIELD_GRID_IMPEDANCE_FAULT_VALUE:
+    return data.grid_impedance_fault_value;
+  case REALTIME_FIELD_TEMPERATURE_FAULT:
+    return data.temperature_fault;
+  case REALTIME_FIELD_PV_VOLTAGE_FAULT:
+    return data.pv_voltage_fault;
+  case REALTIME_FIELD_GFCI_CURRENT_FAULT:
+    return data.gfci_current_fault;
+  case REALTIME_FIELD_ERROR_MESSAGE_BINARY_INDEX:
+    return data.error_message_binary_index;
+  default:
+    return 0;
+  }
+}
+
+/**
+ * @see the header file.
+ */
+float scale_realtime_field(RealtimeField field, int32_t value) {
+  uint8_t decimals = REALTIME_FIELDS[field].decimals;
+  if (decimals == 0) {
+    return value;
+  }
+  return value / DIVISORS[decimals];
+}
+
+/**
+ * @see the header file.
+ */
+int format_realtime_field(RealtimeField field, int32_t value, char text[],
+                          size_t size) {
+  uint8_t decimals = REALTIME_FIELDS[field].decimals;
+  if (decimals == 0) {
+    return snprintf(text, size, "%" PRId32, value);
+  }
+  // The magnitude as unsigned, so that INT32_MIN can't overflow.
+  uint32_t magnitude = value < 0 ? 0u - (uint32_t) value : (uint32_t) value;
+  uint32_t divisor = INTEGER_DIVISORS[decimals];
+  return snprintf(text, size, "%s%" PRIu32 ".%0*" PRIu32, value < 0 ? "-" : "",
+                  magnitude / divisor, (int) decimals, magnitude % divisor);
+}
+
+} // namespace omnik_inverter
+} // namespace esphome
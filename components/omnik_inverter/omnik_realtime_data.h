@@ -0,0 +1,241 @@
+#pragma once
+
+#include "../omnik_base/omnik_text.h"
+#include "omnik_message_layout.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// This file doesn't depend on ESPHome, so that it can also be used by the
+// host tools.
+
+namespace esphome {
+namespace omnik_inverter {
+
+/**
+ * The raw (not scaled) values of an Omnik 0x11/0x90 message.
+ */
+struct RealtimeData {
+  int16_t temperature;
+  uint16_t pv1_voltage;
+  uint16_t pv2_voltage;
+  uint16_t pv3_voltage;
+  uint16_t pv1_current;
+  uint16_t pv2_current;
+  uint16_t pv3_current;
+  uint16_t r_current;
+  uint16_t s_current;
+  uint16_t t_current;
+  uint16_t r_voltage;
+  uint16_t s_voltage;
+  uint16_t t_voltage;
+  uint16_t r_frequency;
+  uint16_t r_power;
+  uint16_t s_frequency;
+  uint16_t s_power;
+  uint16_t t_frequency;
+  uint16_t t_power;
+  uint16_t energy_today;
+  uint32_t energy_total;
+  uint32_t hours_total;
+  uint16_t run_state;
+  uint16_t grid_voltage_fault_value;
+  uint16_t grid_frequency_fault_value;
+  uint16_t grid_impedance_fault_value;
+  uint16_t temperature_fault;
+  uint16_t pv_voltage_fault;
+  uint16_t gfci_current_fault;
+  uint32_t error_message_binary_index;
+};
+
+/**
+ * The fields of RealtimeData.
+ */
+enum RealtimeField : uint8_t {
+  REALTIME_FIELD_TEMPERATURE,
+  REALTIME_FIELD_PV1_VOLTAGE,
+  REALTIME_FIELD_PV2_VOLTAGE,
+  REALTIME_FIELD_PV3_VOLTAGE,
+  REALTIME_FIELD_PV1_CURRENT,
+  REALTIME_FIELD_PV2_CURRENT,
+  REALTIME_FIELD_PV3_CURRENT,
+  REALTIME_FIELD_R_CURRENT,
+  REALTIME_FIELD_S_CURRENT,
+  REALTIME_FIELD_T_CURRENT,
+  REALTIME_FIELD_R_VOLTAGE,
+  REALTIME_FIELD_S_VOLTAGE,
+  REALTIME_FIELD_T_VOLTAGE,
+  REALTIME_FIELD_R_FREQUENCY,
+  REALTIME_FIELD_R_POWER,
+  REALTIME_FIELD_S_FREQUENCY,
+  REALTIME_FIELD_S_POWER,
+  REALTIME_FIELD_T_FREQUENCY,
+  REALTIME_FIELD_T_POWER,
+  REALTIME_FIELD_ENERGY_TODAY,
+  REALTIME_FIELD_ENERGY_TOTAL,
+  REALTIME_FIELD_HOURS_TOTAL,
+  REALTIME_FIELD_RUN_STATE,
+  REALTIME_FIELD_GRID_VOLTAGE_FAULT_VALUE,
+  REALTIME_FIELD_GRID_FREQUENCY_FAULT_VALUE,
+  REALTIME_FIELD_GRID_IMPEDANCE_FAULT_VALUE,
+  REALTIME_FIELD_TEMPERATURE_FAULT,
+  REALTIME_FIELD_PV_VOLTAGE_FAULT,
+  REALTIME_FIELD_GFCI_CURRENT_FAULT,
+  REALTIME_FIELD_ERROR_MESSAGE_BINARY_INDEX,
+};
+
+// The number of fields of RealtimeData.
+static const uint8_t NR_OF_REALTIME_FIELDS =
+    REALTIME_FIELD_ERROR_MESSAGE_BINARY_INDEX + 1;
+// The size of the data of an Omnik 0x11/0x90 message that contains the
+// values of RealtimeData.
+static const size_t REALTIME_DATA_SIZE = 66;
+
+/**
+ * The description of a field of RealtimeData.
+ */
+struct RealtimeFieldInfo {
+  // The field.
+  RealtimeField field;
+  // The name of the field.
+  const char *name;
+  // The number of decimals of the raw value.
+  uint8_t decimals;
+};
+
+// The descriptions of the fields of RealtimeData (in the order of
+// RealtimeField). The table is generated from realtime_fields.py, by the code
+// generation of the component and by the Makefile for the host tools.
+extern const RealtimeFieldInfo REALTIME_FIELDS[];
+
+/**
+ * Check that the descriptions of the fields are in the order of RealtimeField.
+ */
+constexpr bool is_in_field_order(
+    const RealtimeFieldInfo (&fields)[NR_OF_REALTIME_FIELDS]) {
+  for (uint8_t i = 0; i < NR_OF_REALTIME_FIELDS; i++) {
+    if (fields[i].field != i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Get the name of a field.
+ */
+const char *get_realtime_field_name(RealtimeField field);
+
+/**
+ * Get the number of decimals of the raw value of a field.
+ */
+uint8_t get_realtime_field_decimals(RealtimeField field);
+
+/**
+ * Get the raw value of a field.
+ */
+int32_t get_realtime_field(const RealtimeData &data, RealtimeField field);
+
+/**
+ * Scale the raw value of a field with its number of decimals.
+ *
+ * The raw value is divided as a float, which is a lot cheaper than a double
+ * on a CPU without an FPU (the ESP8266). For raw values up to 2^24 the result
+ * is bit for bit the same as dividing as a double and converting the result to
+ * a float, because rounding twice is harmless for a division when the double
+ * has more than twice the precision of the float. Larger raw values are
+ * rounded to a float before the division, which differs at most 1 ULP.
+ *
+ * @param field The field.
+ * @param value The raw value of the field.
+ * @return The scaled value.
+ */
+float scale_realtime_field(RealtimeField field, int32_t value);
+
+/**
+ * Format the raw value of a field as its scaled value with all its decimals,
+ * e.g. 2305 with 1 decimal as "230.5". The digits are formatted as integers,
+ * so the text is exact.
+ *
+ * @param field The field.
+ * @param value The raw value of the field.
+ * @param text The text.
+ * @param size The size of the text.
+ * @return The length of the text, like snprintf().
+ */
+int format_realtime_field(RealtimeField field, int32_t value, char text[],
+                          size_t size);
+
+/**
+ * Decode the values of an Omnik 0x11/0x90 message.
+ *
+ * This is a template on the reader, like the message handlers that use it.
+ *
+ * @param reader The data of the message.
+ * @param data The decoded values.
+ */
+template <typename Reader>
+void decode_realtime_data(Reader &reader, RealtimeData &data) {
+  data.temperature = reader.get_int16();
+  data.pv1_voltage = reader.get_uint16();
+  data.pv2_voltage = reader.get_uint16();
+  data.pv3_voltage = reader.get_uint16();
+  data.pv1_current = reader.get_uint16();
+  data.pv2_current = reader.get_uint16();
+  data.pv3_current = reader.get_uint16();
+  data.r_current = reader.get_uint16();
+  data.s_current = reader.get_uint16();
+  data.t_current = reader.get_uint16();
+  data.r_voltage = reader.get_uint16();
+  data.s_voltage = reader.get_uint16();
+  data.t_voltage = reader.get_uint16();
+  data.r_frequency = reader.get_uint16();
+  data.r_power = reader.get_uint16();
+  data.s_frequency = reader.get_uint16();
+  data.s_power = reader.get_uint16();
+  data.t_frequency = reader.get_uint16();
+  data.t_power = reader.get_uint16();
+  data.energy_today = reader.get_uint16();
+  data.energy_total = reader.get_uint32();
+  data.hours_total = reader.get_uint32();
+  data.run_state = reader.get_uint16();
+  data.grid_voltage_fault_value = reader.get_uint16();
+  data.grid_frequency_fault_value = reader.get_uint16();
+  data.grid_impedance_fault_value = reader.get_uint16();
+  data.temperature_fault = reader.get_uint16();
+  data.pv_voltage_fault = reader.get_uint16();
+  data.gfci_current_fault = reader.get_uint16();
+  data.error_message_binary_index = reader.get_uint32();
+}
+
+/**
+ * Process the firmware versions of an Omnik 0x11/0x90 message, in case the
+ * layout of the message has them. An empty version isn't published.
+ *
+ * @param reader The reader of the data of the message.
+ * @param layout The layout of the message.
+ * @param main The text state of the main firmware version.
+ * @param slave The text state of the slave firmware version.
+ */
+template <typename Reader, typename TextState>
+void process_firmware_versions(Reader &reader, const MessageLayout &layout,
+                               TextState &&main, TextState &&slave) {
+  char firmware_version[FIRMWARE_VERSION_SIZE + 1];
+  if (layout.main_firmware_version_offset != NO_FIELD) {
+    reader.set_position(layout.main_firmware_version_offset);
+    omnik_base::read_string(reader, FIRMWARE_VERSION_SIZE, firmware_version);
+    if (firmware_version[0] != '\0') {
+      main.publish(firmware_version);
+    }
+  }
+  if (layout.slave_firmware_version_offset != NO_FIELD) {
+    reader.set_position(layout.slave_firmware_version_offset);
+    omnik_base::read_string(reader, FIRMWARE_VERSION_SIZE, firmware_version);
+    if (firmware_version[0] != '\0') {
+      slave.publish(firmware_version);
+    }
+  }
+}
+
+} // namespace omnik_inverter
+} // namespace esphome
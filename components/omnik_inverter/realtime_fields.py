@@ -0,0 +1,75 @@
+"""
+The fields of RealtimeData (Omnik 0x11/0x90 message).
+
+This is the single source of the names and the numbers of decimals of the
+fields. The C++ table REALTIME_FIELDS is generated from it, by the code
+generation of omnik_inverter for the firmware and by running this file for
+the host tools:
+
+    python3 components/omnik_inverter/realtime_fields.py > fields.cpp
+
+It doesn't depend on ESPHome, so that it can also be used by the host tools.
+"""
+
+# The number of decimals of the fields of RealtimeData, in the order of
+# RealtimeField.
+REALTIME_FIELD_DECIMALS = {
+    "temperature": 1,
+    "pv1_voltage": 1,
+    "pv2_voltage": 1,
+    "pv3_voltage": 1,
+    "pv1_current": 1,
+    "pv2_current": 1,
+    "pv3_current": 1,
+    "r_current": 1,
+    "s_current": 1,
+    "t_current": 1,
+    "r_voltage": 1,
+    "s_voltage": 1,
+    "t_voltage": 1,
+    "r_frequency": 2,
+    "r_power": 3,
+    "s_frequency": 2,
+    "s_power": 3,
+    "t_frequency": 2,
+    "t_power": 3,
+    "energy_today": 2,
+    "energy_total": 1,
+    "hours_total": 0,
+    "run_state": 0,
+    "grid_voltage_fault_value": 1,
+    "grid_frequency_fault_value": 2,
+    "grid_impedance_fault_value": 3,
+    "temperature_fault": 1,
+    "pv_voltage_fault": 1,
+    "gfci_current_fault": 3,
+    "error_message_binary_index": 0,
+}
+
+def generate_realtime_fields():
+    """
+    Generate the C++ definition of the REALTIME_FIELDS table (declared in
+    omnik_realtime_data.h). The compiler checks that the table has an entry
+    for every RealtimeField, in the order of RealtimeField.
+    """
+    entries = "".join(
+        f'    {{REALTIME_FIELD_{name.upper()}, "{name}", {decimals}}},\n'
+        for name, decimals in REALTIME_FIELD_DECIMALS.items())
+    return (
+        "namespace esphome {\n"
+        "namespace omnik_inverter {\n"
+        "constexpr RealtimeFieldInfo REALTIME_FIELDS[] = {\n"
+        f"{entries}"
+        "};\n"
+        "static_assert(is_in_field_order(REALTIME_FIELDS),\n"
+        '              "REALTIME_FIELDS isn\'t in the order of "\n'
+        '              "RealtimeField");\n'
+        "} // namespace omnik_inverter\n"
+        "} // namespace esphome\n"
+    )
+
+if __name__ == "__main__":
+    print('#include "omnik_inverter/omnik_realtime_data.h"\n')
+    print(generate_realtime_fields(), end="")
+
+# vim:sw=4:
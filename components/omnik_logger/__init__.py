@@ -13,6 +13,7 @@ from esphome.const import (
 )
 from ..omnik_base import (
     to_code_base,
+    validate_base,
     OmnikBase,
     CONFIG_SCHEMA_BASE,
 )
@@ -33,7 +34,7 @@ OmnikLogger = omnik_logger_ns.class_(
 CONF_CONNECTION_NUMBER = "connection_number"
 CONF_SERIAL_DEVICE_NUMBER = "serial_device_number"
 
-CONFIG_SCHEMA = CONFIG_SCHEMA_BASE.extend({
+CONFIG_SCHEMA = cv.All(CONFIG_SCHEMA_BASE.extend({
     cv.GenerateID(): cv.declare_id(OmnikLogger),
     cv.Optional(CONF_CONNECTION_NUMBER,
                 default={
@@ -50,7 +51,7 @@ CONFIG_SCHEMA = CONFIG_SCHEMA_BASE.extend({
                     CONF_NAME: "Logger Serial device number",
                     CONF_ENTITY_CATEGORY: ENTITY_CATEGORY_DIAGNOSTIC,
                 }): ts.text_sensor_schema(),
-})
+}), validate_base("Logger"))
 
 async def to_code(config):
     # breakpoint()
@@ -58,7 +59,7 @@ async def to_code(config):
 
     for sensor_key in config:
         sensor_config = config[sensor_key]
-        if not isinstance(sensor_config, dict):
+        if not isinstance(sensor_config, dict) or CONF_ID not in sensor_config:
             continue
         sensor_id = sensor_config[CONF_ID]
         sensor_type = sensor_id.type
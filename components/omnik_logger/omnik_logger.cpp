@@ -4,7 +4,7 @@ namespace esphome {
 namespace omnik_logger {
 
 // Tag that is used for log messages.
-static const char *const TAG = "omnik_logger";
+static const char *const TAG = OmnikLogger::LOG_TAG;
 
 /**
  * @see the header file.
@@ -23,64 +23,28 @@ void OmnikLogger::dump_config() {
 /**
  * @see the header file.
  */
-void OmnikLogger::process_omnik_message(uint8_t control_code,
-                                        uint8_t function_code,
-                                        ByteBuffer &buffer) {
-  switch (OMNIK_MESSAGE_ID(control_code, function_code)) {
-  case OMNIK_MESSAGE_ID(0x10, 0x01):
-    omnik_message_10_01(buffer);
-    break;
-
-  case OMNIK_MESSAGE_ID(0x12, 0x40):
-    omnik_message_12_40(buffer);
-    break;
-
-  case OMNIK_MESSAGE_ID(0x12, 0x41):
-    omnik_message_12_41(buffer);
-    break;
-
-  case OMNIK_MESSAGE_ID(0x10, 0x00):
-  case OMNIK_MESSAGE_ID(0x10, 0x04):
-  case OMNIK_MESSAGE_ID(0x11, 0x03):
-  case OMNIK_MESSAGE_ID(0x11, 0x10):
-  case OMNIK_MESSAGE_ID(0x11, 0x43):
-    omnik_message_no_data(buffer);
-    break;
-
-  default:
-    ESP_LOGW(TAG,
-             "Unknown combination: control_code=0x%02x, function_code=0x%02x",
-             control_code, function_code);
-    break;
-  }
-}
-
-/**
- * @see the header file.
- */
-void OmnikLogger::omnik_message_10_01(ByteBuffer &buffer) {
-  std::string serial_number = omnik_base::to_string(buffer.get_vector(16));
-  ESP_LOGI(TAG, "Inverter serial number: %s", serial_number.c_str());
-
-  uint8_t connection_number = buffer.get_uint8();
-  connection_number_text_sensor_->publish_state(
-      std::to_string(connection_number));
+void OmnikLogger::omnik_message_10_01(omnik_base::BigEndianReader &buffer) {
+  char serial_number[SERIAL_NUMBER_SIZE + 1];
+  process_message_10_01(
+      buffer, serial_number,
+      omnik_base::ChangedTextState(connection_number_text_sensor_));
+  ESP_LOGI(TAG, "Inverter serial number: %s", serial_number);
 }
 
 /**
  * @see the header file.
  */
-void OmnikLogger::omnik_message_12_40(ByteBuffer &buffer) {
-  std::string serial_number = omnik_base::to_string(buffer.get_vector(16));
-  serial_device_number_text_sensor_->publish_state(serial_number);
+void OmnikLogger::omnik_message_12_40(omnik_base::BigEndianReader &buffer) {
+  omnik_base::process_string_message<SERIAL_NUMBER_SIZE>(
+      buffer, omnik_base::ChangedTextState(serial_device_number_text_sensor_));
 }
 
 /**
  * @see the header file.
  */
-void OmnikLogger::omnik_message_12_41(ByteBuffer &buffer) {
-  std::string ip_address = omnik_base::to_string(buffer.get_vector(16));
-  ip_address_text_sensor_->publish_state(ip_address);
+void OmnikLogger::omnik_message_12_41(omnik_base::BigEndianReader &buffer) {
+  omnik_base::process_string_message<IP_ADDRESS_SIZE>(
+      buffer, omnik_base::ChangedTextState(ip_address_text_sensor_));
 }
 
 } // namespace omnik_logger
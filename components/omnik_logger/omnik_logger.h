@@ -1,8 +1,10 @@
 #pragma once
 
 #include "esphome/components/omnik_base/omnik_base.h"
+#include "esphome/components/omnik_base/omnik_device.h"
 #include "esphome/components/sensor/sensor.h"
 #include "esphome/components/text_sensor/text_sensor.h"
+#include "omnik_logger_messages.h"
 
 namespace esphome {
 namespace omnik_logger {
@@ -11,8 +13,11 @@ namespace omnik_logger {
  * This class is responsible for processing the messages received from the Omnik
  * logger.
  */
-class OmnikLogger : public omnik_base::OmnikBase {
+class OmnikLogger : public omnik_base::OmnikDevice<OmnikLogger> {
 public:
+  // Tag that is used for log messages.
+  static constexpr const char *const LOG_TAG = "omnik_logger";
+
   /**
    * Log the current configuration.
    */
@@ -22,23 +27,8 @@ public:
   SUB_TEXT_SENSOR(ip_address)
   SUB_TEXT_SENSOR(serial_device_number)
 
-protected:
-  /**
-   * process an Omnik message.
-   *
-   * See omnik_base::OmnikBase for a full description.
-   */
-  void process_omnik_message(uint8_t control_code, uint8_t function_code,
-                             ByteBuffer &buffer) override;
-
 private:
-  /**
-   * Process an Omnik message that contains no data.
-   *
-   * @param buffer The data of the message.
-   *               (no data)
-   */
-  void omnik_message_no_data(ByteBuffer &buffer) {}
+  friend class omnik_base::OmnikDevice<OmnikLogger>;
 
   /**
    * Process an Omnik 0x10/0x01 message.
@@ -47,7 +37,7 @@ private:
    * 		   data[0-15]: Inverter serial number
    * 		   data[16]:   Connected inverter number
    */
-  void omnik_message_10_01(ByteBuffer &buffer);
+  void omnik_message_10_01(omnik_base::BigEndianReader &buffer);
 
   /**
    * Process an Omnik 0x12/0x40 message.
@@ -55,7 +45,7 @@ private:
    * @param buffer The data of the message.
    * 		   data[0-15]: Device serial number (\0 terminated)
    */
-  void omnik_message_12_40(ByteBuffer &buffer);
+  void omnik_message_12_40(omnik_base::BigEndianReader &buffer);
 
   /**
    * Process an Omnik 0x12/0x41 message.
@@ -63,7 +53,27 @@ private:
    * @param buffer The data of the message.
    * 		   data[0-15]: IP address (\0 terminated)
    */
-  void omnik_message_12_41(ByteBuffer &buffer);
+  void omnik_message_12_41(omnik_base::BigEndianReader &buffer);
+
+  // The handlers of the messages, sorted by message id.
+  static constexpr MessageHandler MESSAGE_HANDLERS[] = {
+      {OMNIK_MESSAGE_ID(0x10, 0x00), omnik_base::ANY_DATA_SIZE,
+       &OmnikLogger::omnik_message_no_data},
+      {OMNIK_MESSAGE_ID(0x10, 0x01), MESSAGE_10_01_SIZE,
+       &OmnikLogger::omnik_message_10_01},
+      {OMNIK_MESSAGE_ID(0x10, 0x04), omnik_base::ANY_DATA_SIZE,
+       &OmnikLogger::omnik_message_no_data},
+      {OMNIK_MESSAGE_ID(0x11, 0x03), omnik_base::ANY_DATA_SIZE,
+       &OmnikLogger::omnik_message_no_data},
+      {OMNIK_MESSAGE_ID(0x11, 0x10), omnik_base::ANY_DATA_SIZE,
+       &OmnikLogger::omnik_message_no_data},
+      {OMNIK_MESSAGE_ID(0x11, 0x43), omnik_base::ANY_DATA_SIZE,
+       &OmnikLogger::omnik_message_no_data},
+      {OMNIK_MESSAGE_ID(0x12, 0x40), SERIAL_NUMBER_SIZE,
+       &OmnikLogger::omnik_message_12_40},
+      {OMNIK_MESSAGE_ID(0x12, 0x41), IP_ADDRESS_SIZE,
+       &OmnikLogger::omnik_message_12_41},
+  };
 };
 
 } // namespace omnik_logger
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../omnik_base/omnik_text.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// This file doesn't depend on ESPHome, so that it can also be used by the
+// host tools.
+
+namespace esphome {
+namespace omnik_logger {
+
+// The size of the serial numbers.
+static const size_t SERIAL_NUMBER_SIZE = 16;
+// The size of the IP address.
+static const size_t IP_ADDRESS_SIZE = 16;
+// The data size of the 0x10/0x01 message.
+static const uint16_t MESSAGE_10_01_SIZE = SERIAL_NUMBER_SIZE + 1;
+
+/**
+ * Process an Omnik 0x10/0x01 message: the connection number is published.
+ *
+ * @param reader The reader of the data of the message.
+ * @param serial_number The serial number of the inverter (at least
+ *                      SERIAL_NUMBER_SIZE + 1 characters).
+ * @param connection_number The text state of the connection number.
+ */
+template <typename Reader, typename TextState>
+void process_message_10_01(Reader &reader, char serial_number[],
+                           TextState &&connection_number) {
+  omnik_base::read_string(reader, SERIAL_NUMBER_SIZE, serial_number);
+  char text[4];
+  snprintf(text, sizeof(text), "%u", reader.get_uint8());
+  connection_number.publish(text);
+}
+
+} // namespace omnik_logger
+} // namespace esphome
@@ -0,0 +1,54 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.const import (
+    CONF_ID,
+    CONF_PORT,
+)
+from ..omnik_inverter import (
+    OmnikInverter,
+)
+
+AUTO_LOAD = [
+    "socket",
+]
+DEPENDENCIES = [
+    "network",
+]
+MULTI_CONF = True
+
+omnik_server_ns = cg.esphome_ns.namespace("omnik_server")
+OmnikServer = omnik_server_ns.class_(
+    "OmnikServer",
+    cg.Component,
+)
+
+CONF_INVERTERS = "inverters"
+CONF_MAX_CLIENTS = "max_clients"
+CONF_WRITE_TIMEOUT = "write_timeout"
+
+CONFIG_SCHEMA = (
+    cv.COMPONENT_SCHEMA
+    .extend({
+        cv.GenerateID(): cv.declare_id(OmnikServer),
+        cv.Required(CONF_INVERTERS):
+            cv.ensure_list(cv.use_id(OmnikInverter)),
+        cv.Optional(CONF_PORT, default=8899): cv.port,
+        cv.Optional(CONF_MAX_CLIENTS, default=4): cv.int_range(min=1, max=16),
+        cv.Optional(CONF_WRITE_TIMEOUT, default="5s"):
+            cv.positive_time_period_milliseconds,
+    })
+)
+
+async def to_code(config):
+    comp = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(comp, config)
+    cg.add(comp.set_port(config[CONF_PORT]))
+    cg.add(comp.set_max_clients(config[CONF_MAX_CLIENTS]))
+    cg.add(comp.set_write_timeout(
+        config[CONF_WRITE_TIMEOUT].total_milliseconds))
+
+    for inverter_id in config[CONF_INVERTERS]:
+        inverter = await cg.get_variable(inverter_id)
+        cg.add(comp.add_inverter(inverter, inverter_id.id))
+
+# vim:sw=4:
@@ -0,0 +1,247 @@
+#include "omnik_server.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+#include <cerrno>
+#include <cinttypes>
+
+namespace esphome {
+namespace omnik_server {
+
+// Tag that is used for log messages.
+static const char *const TAG = "omnik_server";
+// The number of connections that may wait to be accepted.
+static const int LISTEN_BACKLOG = 4;
+
+/**
+ * Append a string to a JSON text as a string value.
+ */
+static void append_string(std::string &text, const char *value) {
+  text += '"';
+  for (const char *c = value; *c != '\0'; c++) {
+    text += (*c == '"' || *c == '\\' || (unsigned char) *c < ' ') ? '_' : *c;
+  }
+  text += '"';
+}
+
+/**
+ * Append a field of the info to a JSON text.
+ */
+static void append_info_field(std::string &text, const char *name,
+                              const std::string &value) {
+  text += ",\"";
+  text += name;
+  text += "\":";
+  append_string(text, value.c_str());
+}
+
+/**
+ * Append the values of an Omnik 0x11/0x90 message to a JSON text.
+ */
+static void append_realtime_data(std::string &text, uint32_t sequence_number,
+                                 const omnik_inverter::RealtimeData &data) {
+  char number[24];
+  snprintf(number, sizeof(number), "%u", (unsigned) sequence_number);
+  text += "\"realtime\":{\"seq\":";
+  text += number;
+  for (uint8_t i = 0; i < omnik_inverter::NR_OF_REALTIME_FIELDS; i++) {
+    omnik_inverter::RealtimeField field = (omnik_inverter::RealtimeField) i;
+    int32_t value = omnik_inverter::get_realtime_field(data, field);
+    uint8_t decimals = omnik_inverter::get_realtime_field_decimals(field);
+    if (decimals == 0) {
+      snprintf(number, sizeof(number), "%" PRId32, value);
+    } else {
+      snprintf(number, sizeof(number), "%.*f", decimals,
+               omnik_inverter::scale_realtime_field(field, value));
+    }
+    text += ",\"";
+    text += omnik_inverter::get_realtime_field_name(field);
+    text += "\":";
+    text += number;
+  }
+  text += '}';
+}
+
+/**
+ * Append the values of an Omnik 0x11/0x83 message to a JSON text.
+ */
+static void append_info(std::string &text, uint32_t sequence_number,
+                        const omnik_inverter::InverterInfo &info) {
+  char number[12];
+  snprintf(number, sizeof(number), "%u", (unsigned) sequence_number);
+  text += "\"info\":{\"seq\":";
+  text += number;
+  snprintf(number, sizeof(number), "%u", info.nr_of_phases);
+  text += ",\"nr_of_phases\":";
+  text += number;
+  append_info_field(text, "rated_power", info.rated_power);
+  append_info_field(text, "country", info.country);
+  append_info_field(text, "firmware_version_main", info.firmware_version_main);
+  append_info_field(text, "firmware_version_slave",
+                    info.firmware_version_slave);
+  append_info_field(text, "inverter_model", info.inverter_model);
+  append_info_field(text, "brand", info.brand);
+  append_info_field(text, "serial_number", info.serial_number);
+  text += '}';
+}
+
+/**
+ * @see the header file.
+ */
+void OmnikServer::setup() {
+  this->socket_ = socket::socket_ip(SOCK_STREAM, 0);
+  if (this->socket_ == nullptr) {
+    ESP_LOGE(TAG, "Could not create a socket");
+    this->mark_failed();
+    return;
+  }
+  int enable = 1;
+  this->socket_->setsockopt(SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+  this->socket_->setblocking(false);
+
+  struct sockaddr_storage address;
+  socklen_t address_length = socket::set_sockaddr_any(
+      (struct sockaddr *) &address, sizeof(address), this->port_);
+  if (address_length == 0 ||
+      this->socket_->bind((struct sockaddr *) &address, address_length) != 0 ||
+      this->socket_->listen(LISTEN_BACKLOG) != 0) {
+    ESP_LOGE(TAG, "Could not listen on port %u: errno %d", this->port_, errno);
+    this->mark_failed();
+    return;
+  }
+  this->clients_.reserve(this->max_clients_);
+}
+
+/**
+ * @see the header file.
+ */
+void OmnikServer::loop() {
+  const uint32_t now = millis();
+
+  // Accept the new clients, but not more than the maximum. The other
+  // connections wait in the backlog.
+  while (this->clients_.size() < this->max_clients_) {
+    struct sockaddr_storage address;
+    socklen_t address_length = sizeof(address);
+    std::unique_ptr<socket::Socket> socket =
+        this->socket_->accept((struct sockaddr *) &address, &address_length);
+    if (socket == nullptr) {
+      break;
+    }
+    socket->setblocking(false);
+    this->clients_.push_back({std::move(socket), 0, now});
+    this->nr_of_clients_++;
+  }
+  if (this->clients_.empty()) {
+    return;
+  }
+
+  // All the clients that are waiting for the cache start at the same time, so
+  // that the cache can be rebuilt in between.
+  bool is_sending = false;
+  for (const Client &client : this->clients_) {
+    is_sending = is_sending || client.position > 0;
+  }
+  if (!is_sending) {
+    this->update_cache();
+  }
+
+  for (size_t i = 0; i < this->clients_.size();) {
+    if (this->send(this->clients_[i], now)) {
+      this->clients_[i].socket->close();
+      this->clients_.erase(this->clients_.begin() + i);
+    } else {
+      i++;
+    }
+  }
+}
+
+/**
+ * @see the header file.
+ */
+void OmnikServer::update_cache() {
+  bool is_changed = this->cache_.empty();
+  for (const Inverter &inverter : this->inverters_) {
+    is_changed = is_changed ||
+                 inverter.realtime_sequence_number !=
+                     inverter.inverter->get_realtime_sequence_number() ||
+                 inverter.info_sequence_number !=
+                     inverter.inverter->get_info_sequence_number();
+  }
+  if (!is_changed) {
+    return;
+  }
+
+  // The cache keeps its capacity, so it is only allocated the first times.
+  std::string &text = this->cache_;
+  text.clear();
+  text += '{';
+  for (Inverter &inverter : this->inverters_) {
+    omnik_inverter::OmnikInverter *device = inverter.inverter;
+    inverter.realtime_sequence_number = device->get_realtime_sequence_number();
+    inverter.info_sequence_number = device->get_info_sequence_number();
+    if (text.size() > 1) {
+      text += ',';
+    }
+    append_string(text, inverter.name);
+    text += ":{";
+    if (device->has_realtime_data()) {
+      append_realtime_data(text, inverter.realtime_sequence_number,
+                           device->get_realtime_data());
+    }
+    if (device->has_info()) {
+      if (device->has_realtime_data()) {
+        text += ',';
+      }
+      append_info(text, inverter.info_sequence_number, device->get_info());
+    }
+    text += '}';
+  }
+  text += "}\n";
+  this->nr_of_rebuilds_++;
+}
+
+/**
+ * @see the header file.
+ */
+bool OmnikServer::send(Client &client, uint32_t now) {
+  ssize_t nr_of_bytes = client.socket->write(
+      this->cache_.data() + client.position,
+      this->cache_.size() - client.position);
+  if (nr_of_bytes < 0) {
+    if (errno != EWOULDBLOCK && errno != EAGAIN) {
+      return true;
+    }
+    nr_of_bytes = 0;
+  }
+  if (nr_of_bytes > 0) {
+    client.position += nr_of_bytes;
+    client.progress_time = now;
+  } else if (now - client.progress_time >= this->write_timeout_) {
+    ESP_LOGW(TAG, "Dropped a client that didn't receive any bytes for %u ms",
+             (unsigned) this->write_timeout_);
+    this->nr_of_dropped_clients_++;
+    return true;
+  }
+  return client.position == this->cache_.size();
+}
+
+/**
+ * @see the header file.
+ */
+void OmnikServer::dump_config() {
+  ESP_LOGCONFIG(TAG, "OmnikServer:");
+  ESP_LOGCONFIG(TAG, "  Port: %u", this->port_);
+  ESP_LOGCONFIG(TAG, "  Max Clients: %u", this->max_clients_);
+  ESP_LOGCONFIG(TAG, "  Write Timeout: %u ms", (unsigned) this->write_timeout_);
+  for (const Inverter &inverter : this->inverters_) {
+    ESP_LOGCONFIG(TAG, "  Inverter: %s", inverter.name);
+  }
+  ESP_LOGCONFIG(TAG, "  Clients Served: %u", (unsigned) this->nr_of_clients_);
+  ESP_LOGCONFIG(TAG, "  Clients Dropped: %u",
+                (unsigned) this->nr_of_dropped_clients_);
+  ESP_LOGCONFIG(TAG, "  Cache Rebuilds: %u", (unsigned) this->nr_of_rebuilds_);
+}
+
+} // namespace omnik_server
+} // namespace esphome
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "esphome/components/omnik_inverter/omnik_inverter.h"
+#include "esphome/components/socket/socket.h"
+#include "esphome/core/component.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace omnik_server {
+
+/**
+ * An inverter of which the values are served.
+ */
+struct Inverter {
+  // The inverter.
+  omnik_inverter::OmnikInverter *inverter;
+  // The name of the inverter (used as the key in the response).
+  const char *name;
+  // The sequence number of the 0x11/0x90 message in the cache.
+  uint32_t realtime_sequence_number;
+  // The sequence number of the 0x11/0x83 message in the cache.
+  uint32_t info_sequence_number;
+};
+
+/**
+ * A client to which the cache is being sent.
+ */
+struct Client {
+  // The socket of the client.
+  std::unique_ptr<socket::Socket> socket;
+  // The number of bytes of the cache that have been sent.
+  size_t position;
+  // The time (millis()) at which the last bytes were sent, or at which the
+  // client was accepted.
+  uint32_t progress_time;
+};
+
+/**
+ * This class is responsible for serving the last decoded values of the
+ * inverters over TCP to any number of local clients.
+ *
+ * A client that connects receives one line with a JSON object, and then the
+ * connection is closed:
+ * {"<name>":{"realtime":{"seq":<n>,<field>:<value>,...},
+ *  "info":{"seq":<n>,<field>:"<value>",...}},...}
+ * The "realtime" and "info" objects are only present once the 0x11/0x90 and
+ * 0x11/0x83 messages have been received.
+ *
+ * The line is kept in a cache, which is only rebuilt once a new message has
+ * been received, so that all the clients are served from the same serialised
+ * bytes. The cache isn't rebuilt while it is being sent to a client, so a
+ * client that doesn't make progress for the write timeout is dropped. Then it
+ * can't freeze the cache or keep a slot.
+ */
+class OmnikServer : public Component {
+public:
+  /**
+   * Serve the values of an inverter.
+   *
+   * @param inverter The inverter.
+   * @param name The name of the inverter.
+   */
+  void add_inverter(omnik_inverter::OmnikInverter *inverter,
+                    const char *name) {
+    this->inverters_.push_back({inverter, name, 0, 0});
+  }
+
+  /**
+   * Set the TCP port on which the values are served.
+   */
+  void set_port(uint16_t port) { this->port_ = port; }
+
+  /**
+   * Set the maximum number of clients that are served at the same time.
+   */
+  void set_max_clients(uint8_t max_clients) {
+    this->max_clients_ = max_clients;
+  }
+
+  /**
+   * Set the time (in milliseconds) after which a client to which no bytes
+   * could be sent is dropped.
+   */
+  void set_write_timeout(uint32_t write_timeout) {
+    this->write_timeout_ = write_timeout;
+  }
+
+  /**
+   * Open the listening socket.
+   */
+  void setup() override;
+
+  /**
+   * Accept the new clients and send the cache to the clients.
+   */
+  void loop() override;
+
+  /**
+   * Log the current configuration.
+   */
+  void dump_config() override;
+
+  /**
+   * The network has to be set up first.
+   */
+  float get_setup_priority() const override {
+    return setup_priority::AFTER_WIFI;
+  }
+
+private:
+  // The inverters of which the values are served.
+  std::vector<Inverter> inverters_;
+  // The TCP port on which the values are served.
+  uint16_t port_{8899};
+  // The maximum number of clients that are served at the same time.
+  uint8_t max_clients_{4};
+  // The time (in milliseconds) after which a client to which no bytes could
+  // be sent is dropped.
+  uint32_t write_timeout_{5000};
+  // The listening socket.
+  std::unique_ptr<socket::Socket> socket_;
+  // The clients to which the cache is being sent.
+  std::vector<Client> clients_;
+  // The serialised values of the inverters (one line).
+  std::string cache_;
+  // The number of times the cache has been rebuilt.
+  uint32_t nr_of_rebuilds_{0};
+  // The number of clients that have been served.
+  uint32_t nr_of_clients_{0};
+  // The number of clients that have been dropped after the write timeout.
+  uint32_t nr_of_dropped_clients_{0};
+
+  /**
+   * Rebuild the cache in case a new message has been received.
+   */
+  void update_cache();
+
+  /**
+   * Send the rest of the cache to a client.
+   *
+   * @param client The client.
+   * @param now The current time (millis()).
+   * @return True in case the client is done (served, failed or timed out).
+   */
+  bool send(Client &client, uint32_t now);
+};
+
+} // namespace omnik_server
+} // namespace esphome
@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+"""
+Generate a capture of the UART of an Omnik inverter with all the messages that
+the components handle.
+
+The capture is deterministic, so that it can be used as a fixture of the host
+tools (tools/fixtures/omnik-messages.bin):
+
+    tools/omnik_capture.py tools/fixtures/omnik-messages.bin
+
+Each round of the conversation contains the messages of the logger (0x10/0x01,
+0x12/0x40, 0x12/0x41) and of the inverter (0x10/0x80, 0x10/0x81, 0x10/0x84,
+0x11/0x83, 0x11/0x90 with and without the firmware versions, 0x11/0xC3,
+0x12/0xC0, 0x12/0xC1). The realtime values and some of the status bytes change
+between the rounds, like they do on a real bus.
+"""
+
+import random
+import struct
+import sys
+
+# The number of rounds of the conversation.
+NR_OF_ROUNDS = 50
+# The addresses of the logger and the inverter.
+LOGGER_ADDRESS = 0x0100
+INVERTER_ADDRESS = 0x0001
+# The serial numbers and the IP address (16 bytes each).
+INVERTER_SERIAL = b"NLDN202015123456"
+LOGGER_SERIAL = b"1601234567      "
+IP_ADDRESS = b"192.168.1.42\0\0\0\0"
+
+
+def frame(sender, receiver, control_code, function_code, data):
+    """Return a message with the header and the checksum."""
+    message = (b"\x3A\x3A" + struct.pack(">HH", sender, receiver) +
+               bytes([control_code, function_code, len(data)]) + data)
+    return message + struct.pack(">H", sum(message) & 0xFFFF)
+
+
+def inverter_info():
+    """Return the data of a 0x11/0x83 message."""
+    return (b"\x01" + b"  4000" + b"NL" + struct.pack(">I", 0x050102)[1:] +
+            struct.pack(">I", 0x01020304) + b"OMNIK4000TL2" +
+            b"Omnik Solar     " + INVERTER_SERIAL + bytes(range(17)))
+
+
+def realtime_data(rng, with_versions):
+    """Return the data of a 0x11/0x90 message."""
+    values = [rng.randrange(0, 500) for _ in range(3)]
+    data = struct.pack(">hHHHHHH", rng.randrange(200, 600), *values,
+                       *[rng.randrange(0, 100) for _ in range(3)])
+    data += struct.pack(">HHH", *[rng.randrange(2250, 2400)
+                                  for _ in range(3)])
+    data += struct.pack(">HHHH", rng.randrange(4990, 5010),
+                        rng.randrange(0, 4000), 0, 0)
+    data = data.ljust(60, b"\0")
+    data += struct.pack(">IH", 123456, 1)
+    if with_versions:
+        data += b"V5.01Build230     ".ljust(20, b"\0")
+        data += b"V4.02Build120     ".ljust(20, b"\0")
+    return data
+
+
+def main():
+    rng = random.Random(1)
+    capture = bytearray()
+    for round_number in range(NR_OF_ROUNDS):
+        to_inverter = (LOGGER_ADDRESS, INVERTER_ADDRESS)
+        to_logger = (INVERTER_ADDRESS, LOGGER_ADDRESS)
+        status = round_number // 10
+        capture += frame(*to_inverter, 0x10, 0x01,
+                         INVERTER_SERIAL + bytes([round_number % 3]))
+        capture += frame(*to_logger, 0x10, 0x80, INVERTER_SERIAL)
+        capture += frame(*to_logger, 0x10, 0x81, bytes([status]))
+        capture += frame(*to_logger, 0x10, 0x84, bytes([0x06]))
+        capture += frame(*to_logger, 0x11, 0x83, inverter_info())
+        capture += frame(*to_logger, 0x11, 0x90,
+                         realtime_data(rng, round_number % 2 == 0))
+        capture += frame(*to_logger, 0x11, 0xC3, bytes([status]))
+        capture += frame(*to_logger, 0x12, 0x40, LOGGER_SERIAL)
+        capture += frame(*to_logger, 0x12, 0x41, IP_ADDRESS)
+        capture += frame(*to_logger, 0x12, 0xC0, bytes([status + 1]))
+        capture += frame(*to_logger, 0x12, 0xC1, bytes([0x00]))
+    with open(sys.argv[1], "wb") as file:
+        file.write(capture)
+
+
+if __name__ == "__main__":
+    main()
+
+# vim:sw=4:
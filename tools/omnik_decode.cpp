@@ -0,0 +1,1175 @@
+/**
+ * Decode captures of the UART of an Omnik inverter.
+ *
+ * The captures are decoded with the same frame parser and 0x11/0x90 decoder as
+ * the firmware. The captures are split into chunks, the chunks are decoded in
+ * parallel and the values of the 0x11/0x90 messages are written in the order of
+ * the captures, one column per field.
+ *
+ * Usage: omnik-decode [-j threads] [-c chunk size] [-f csv|bin] [-k kernel]
+ *                     [-o output] capture...
+ *        omnik-decode -b capture...
+ *        omnik-decode -a budget capture...
+ *
+ * The option -k selects the implementation of finding the start bytes and
+ * calculating the checksum (scalar, sse2 or avx2). The option -b benchmarks
+ * the implementations on the captures and verifies that they all give the
+ * same results as the scalar implementation. It also benchmarks and verifies
+ * the scaling of the raw values as a float against the scaling as a double.
+ *
+ * A chunk is scanned for the messages that start in the chunk, reading past the
+ * end of the chunk for the last message. Because a chunk can start in the
+ * middle of a message, the scan of a chunk is resynchronised with the end of
+ * the previous chunk when the output is written. Therefore the output is the
+ * same as the output of one sequential scan, for any number of threads and any
+ * chunk size.
+ *
+ * The option -a receives the captures byte by byte with the same frame
+ * assembler and decoders as the firmware, and counts the heap allocations
+ * (through the replaced operator new) per message ID. The messages are
+ * processed with the same handler code as the firmware: the data is decoded
+ * straight from the frame bytes and the text states are only published in
+ * case they have changed. Only the publish_state() of ESPHome isn't measured.
+ * Only the message IDs that have a handler are reported. It fails in case the
+ * steady state processing of a message (all but the first message of an ID)
+ * allocates more than the budget (the number of allocations per message), or
+ * in case no message is processed at all.
+ *
+ * The binary column format (all values little endian):
+ * * Header: "OMNIKCOL", uint32 version (1), uint32 number of captures, per
+ *   capture: uint32 length and path, uint32 number of columns, per column:
+ *   uint8 type ('u' uint32, 'i' int32, 'Q' uint64), uint8 number of decimals,
+ *   uint8 length and name.
+ * * Row groups: uint32 number of rows (not 0), per column the values of the
+ *   rows.
+ * * End: uint32 0.
+ */
+#include "omnik_base/omnik_frame.h"
+#include "omnik_base/omnik_frame_assembler.h"
+#include "omnik_base/omnik_text.h"
+#include "omnik_inverter/omnik_inverter_info.h"
+#include "omnik_inverter/omnik_message_layout.h"
+#include "omnik_inverter/omnik_realtime_data.h"
+#include "omnik_logger/omnik_logger_messages.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace esphome::omnik_base;
+using namespace esphome::omnik_inverter;
+namespace omnik_logger = esphome::omnik_logger;
+
+// The number of heap allocations and allocated bytes (counted by the replaced
+// operator new).
+static std::atomic<uint64_t> nr_of_allocations{0};
+static std::atomic<uint64_t> nr_of_allocated_bytes{0};
+
+// The replaced operators aren't inlined, because then GCC warns that the
+// memory of operator new is released with free().
+__attribute__((noinline)) void *operator new(size_t size) {
+  nr_of_allocations.fetch_add(1, std::memory_order_relaxed);
+  nr_of_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  void *pointer = malloc(size > 0 ? size : 1);
+  if (pointer == nullptr)
+    throw std::bad_alloc();
+  return pointer;
+}
+
+__attribute__((noinline)) void operator delete(void *pointer) noexcept {
+  free(pointer);
+}
+
+__attribute__((noinline)) void operator delete(void *pointer,
+                                               size_t) noexcept {
+  free(pointer);
+}
+
+namespace {
+
+// The default size of a chunk (in bytes).
+const size_t DEFAULT_CHUNK_SIZE = 16 << 20;
+// The size of the output buffer (in bytes).
+const size_t OUTPUT_BUFFER_SIZE = 1 << 20;
+
+/**
+ * A memory mapped capture.
+ */
+struct Capture {
+  // The path of the capture.
+  std::string path;
+  // The bytes of the capture.
+  const uint8_t *data;
+  // The number of bytes.
+  size_t size;
+};
+
+/**
+ * The position of a correct message in a capture.
+ */
+struct FrameSpan {
+  size_t offset;
+  size_t size;
+};
+
+/**
+ * The values of a 0x11/0x90 message.
+ */
+struct Row {
+  // The position of the message in the capture.
+  size_t offset;
+  uint16_t sender_address;
+  RealtimeData data;
+};
+
+/**
+ * The result of scanning a part of a capture.
+ */
+struct ScanResult {
+  // The correct messages.
+  std::vector<FrameSpan> frames;
+  // The positions of the messages with a checksum error.
+  std::vector<size_t> checksum_errors;
+  // The values of the 0x11/0x90 messages.
+  std::vector<Row> rows;
+  // The rows as CSV (only in case of the CSV output).
+  std::string text;
+  // The end of each row in the text.
+  std::vector<size_t> row_ends;
+};
+
+/**
+ * A part of a capture that is scanned by one thread.
+ */
+struct Chunk {
+  // The index of the capture.
+  uint32_t capture;
+  // The first byte of the chunk.
+  size_t begin;
+  // The byte after the chunk.
+  size_t end;
+  // True in case the chunk has been scanned.
+  bool done;
+  // The result of scanning the chunk.
+  ScanResult result;
+};
+
+/**
+ * Check whether a field is signed.
+ */
+bool is_signed(RealtimeField field) {
+  return field == REALTIME_FIELD_TEMPERATURE;
+}
+
+/**
+ * Get the value of a field with the right sign.
+ */
+int64_t get_value(const RealtimeData &data, RealtimeField field) {
+  int32_t value = get_realtime_field(data, field);
+  return is_signed(field) ? (int64_t) value : (int64_t)(uint32_t) value;
+}
+
+/**
+ * Append an unsigned integer to a text.
+ */
+void append_uint(std::string &text, uint64_t value, uint8_t min_digits = 1) {
+  char digits[20];
+  uint8_t nr_of_digits = 0;
+  do {
+    digits[nr_of_digits++] = '0' + value % 10;
+    value /= 10;
+  } while (value != 0 || nr_of_digits < min_digits);
+  while (nr_of_digits > 0) {
+    text += digits[--nr_of_digits];
+  }
+}
+
+/**
+ * Append a raw value with a number of decimals to a text.
+ */
+void append_scaled(std::string &text, int64_t value, uint8_t decimals) {
+  if (value < 0) {
+    text += '-';
+    value = -value;
+  }
+  uint64_t divisor = 1;
+  for (uint8_t i = 0; i < decimals; i++) {
+    divisor *= 10;
+  }
+  append_uint(text, value / divisor);
+  if (decimals > 0) {
+    text += '.';
+    append_uint(text, value % divisor, decimals);
+  }
+}
+
+/**
+ * Append a value to a binary text (little endian).
+ */
+template <typename T> void append_binary(std::string &text, T value) {
+  for (size_t i = 0; i < sizeof(T); i++) {
+    text += (char) (uint8_t)(value >> (8 * i));
+  }
+}
+
+/**
+ * The writer of the output.
+ */
+class OutputWriter {
+public:
+  explicit OutputWriter(FILE *file) : file_(file) {}
+  virtual ~OutputWriter() = default;
+
+  /**
+   * Check whether the rows are formatted as CSV while scanning.
+   */
+  virtual bool is_csv() const = 0;
+
+  /**
+   * Write the header.
+   */
+  virtual void write_header(const std::vector<Capture> &captures) = 0;
+
+  /**
+   * Write the rows of a result, starting with a row.
+   */
+  virtual void write_rows(uint32_t capture, const ScanResult &result,
+                          size_t first_row) = 0;
+
+  /**
+   * Write the end of the output.
+   */
+  virtual void write_end() {}
+
+protected:
+  // The output file.
+  FILE *file_;
+
+  /**
+   * Write bytes to the output file.
+   */
+  void write(const char *data, size_t size) {
+    if (size > 0 && fwrite(data, 1, size, this->file_) != size) {
+      perror("omnik-decode: write");
+      exit(EXIT_FAILURE);
+    }
+  }
+};
+
+/**
+ * Writes the rows as CSV.
+ */
+class CsvWriter : public OutputWriter {
+public:
+  using OutputWriter::OutputWriter;
+
+  bool is_csv() const override { return true; }
+
+  void write_header(const std::vector<Capture> &) override {
+    std::string header = "capture,offset,sender_address";
+    for (uint8_t i = 0; i < NR_OF_REALTIME_FIELDS; i++) {
+      header += ',';
+      header += get_realtime_field_name((RealtimeField) i);
+    }
+    header += '\n';
+    this->write(header.data(), header.size());
+  }
+
+  void write_rows(uint32_t, const ScanResult &result,
+                  size_t first_row) override {
+    size_t begin = first_row == 0 ? 0 : result.row_ends[first_row - 1];
+    this->write(result.text.data() + begin, result.text.size() - begin);
+  }
+
+  /**
+   * Format a row.
+   */
+  static void format_row(const std::string &path, const Row &row,
+                         std::string &text) {
+    static const char HEX_DIGITS[] = "0123456789ABCDEF";
+    text += path;
+    text += ',';
+    append_uint(text, row.offset);
+    text += ",0x";
+    for (int shift = 12; shift >= 0; shift -= 4) {
+      text += HEX_DIGITS[(row.sender_address >> shift) & 0x0F];
+    }
+    for (uint8_t i = 0; i < NR_OF_REALTIME_FIELDS; i++) {
+      RealtimeField field = (RealtimeField) i;
+      text += ',';
+      append_scaled(text, get_value(row.data, field),
+                    get_realtime_field_decimals(field));
+    }
+    text += '\n';
+  }
+};
+
+/**
+ * Writes the rows in the binary column format.
+ */
+class BinaryWriter : public OutputWriter {
+public:
+  using OutputWriter::OutputWriter;
+
+  bool is_csv() const override { return false; }
+
+  void write_header(const std::vector<Capture> &captures) override {
+    std::string header = "OMNIKCOL";
+    append_binary<uint32_t>(header, 1);
+    append_binary<uint32_t>(header, captures.size());
+    for (const Capture &capture : captures) {
+      append_binary<uint32_t>(header, capture.path.size());
+      header += capture.path;
+    }
+    append_binary<uint32_t>(header, 3 + NR_OF_REALTIME_FIELDS);
+    append_column(header, 'u', 0, "capture");
+    append_column(header, 'Q', 0, "offset");
+    append_column(header, 'u', 0, "sender_address");
+    for (uint8_t i = 0; i < NR_OF_REALTIME_FIELDS; i++) {
+      RealtimeField field = (RealtimeField) i;
+      append_column(header, is_signed(field) ? 'i' : 'u',
+                    get_realtime_field_decimals(field),
+                    get_realtime_field_name(field));
+    }
+    this->write(header.data(), header.size());
+  }
+
+  void write_rows(uint32_t capture, const ScanResult &result,
+                  size_t first_row) override {
+    size_t nr_of_rows = result.rows.size() - first_row;
+    if (nr_of_rows == 0)
+      return;
+    std::string &group = this->group_;
+    group.clear();
+    append_binary<uint32_t>(group, nr_of_rows);
+    for (size_t row = first_row; row < result.rows.size(); row++)
+      append_binary<uint32_t>(group, capture);
+    for (size_t row = first_row; row < result.rows.size(); row++)
+      append_binary<uint64_t>(group, result.rows[row].offset);
+    for (size_t row = first_row; row < result.rows.size(); row++)
+      append_binary<uint32_t>(group, result.rows[row].sender_address);
+    for (uint8_t i = 0; i < NR_OF_REALTIME_FIELDS; i++) {
+      RealtimeField field = (RealtimeField) i;
+      for (size_t row = first_row; row < result.rows.size(); row++) {
+        const RealtimeData &data = result.rows[row].data;
+        append_binary<uint32_t>(group, get_realtime_field(data, field));
+      }
+    }
+    this->write(group.data(), group.size());
+  }
+
+  void write_end() override {
+    std::string end;
+    append_binary<uint32_t>(end, 0);
+    this->write(end.data(), end.size());
+  }
+
+private:
+  // The buffer of a row group.
+  std::string group_;
+
+  /**
+   * Append the description of a column.
+   */
+  static void append_column(std::string &header, char type, uint8_t decimals,
+                            const char *name) {
+    header += type;
+    header += (char) decimals;
+    header += (char) strlen(name);
+    header += name;
+  }
+};
+
+/**
+ * Add a processed message to a result.
+ */
+void add_frame(const Capture &capture, bool is_csv, size_t position,
+               const Frame &frame, FrameStatus status, ScanResult &result) {
+  if (status == FRAME_CHECKSUM_ERROR) {
+    result.checksum_errors.push_back(position);
+    return;
+  }
+  if (status != FRAME_OK)
+    return;
+
+  result.frames.push_back({position, frame.size()});
+  if (frame.control_code != 0x11 || frame.function_code != 0x90 ||
+      find_message_layout(frame.control_code, frame.function_code,
+                          frame.data_size) == nullptr)
+    return;
+
+  Row row;
+  row.offset = position;
+  row.sender_address = frame.sender_address;
+  BigEndianReader reader(frame.data, frame.data_size);
+  decode_realtime_data(reader, row.data);
+  result.rows.push_back(row);
+  if (is_csv) {
+    CsvWriter::format_row(capture.path, row, result.text);
+    result.row_ends.push_back(result.text.size());
+  }
+}
+
+/**
+ * Scan a chunk for the messages that start in the chunk.
+ */
+void scan_chunk(const Capture &capture, bool is_csv, Chunk &chunk) {
+  scan_frames(capture.data, capture.size, chunk.begin, chunk.end,
+              [&](size_t offset, const Frame &frame, FrameStatus status) {
+                add_frame(capture, is_csv, offset, frame, status,
+                          chunk.result);
+              });
+}
+
+/**
+ * Find the first message that starts at or after a position.
+ */
+std::vector<FrameSpan>::const_iterator
+find_frame(const std::vector<FrameSpan> &frames, size_t position) {
+  return std::lower_bound(
+      frames.begin(), frames.end(), position,
+      [](const FrameSpan &frame, size_t offset) {
+        return frame.offset < offset;
+      });
+}
+
+/**
+ * The totals of the decoded captures.
+ */
+struct Totals {
+  size_t nr_of_bytes{0};
+  size_t nr_of_messages{0};
+  size_t nr_of_checksum_errors{0};
+  size_t nr_of_rows{0};
+};
+
+/**
+ * Write the result of a chunk, resynchronised with the previous chunk.
+ *
+ * @param capture The capture of the chunk.
+ * @param chunk The scanned chunk.
+ * @param covered The position up to which the capture has been written. It is
+ *                updated to the end of the chunk.
+ * @param writer The writer of the output.
+ * @param totals The totals.
+ */
+void write_chunk(const Capture &capture, const Chunk &chunk, size_t &covered,
+                 OutputWriter &writer, Totals &totals) {
+  const ScanResult &result = chunk.result;
+  size_t position = std::max(covered, chunk.begin);
+
+  // The scan of the chunk is synchronised with the sequential scan as soon as
+  // the sequential scan reaches a position that was also processed by the scan
+  // of the chunk, that is, a position that isn't inside one of its messages.
+  ScanResult fixup;
+  auto frame = find_frame(result.frames, position);
+  while (position < chunk.end && frame != result.frames.begin() &&
+         std::prev(frame)->offset + std::prev(frame)->size > position) {
+    position = scan_frames(
+        capture.data, capture.size, position, position + 1,
+        [&](size_t offset, const Frame &frame, FrameStatus status) {
+          add_frame(capture, writer.is_csv(), offset, frame, status, fixup);
+        });
+    frame = find_frame(result.frames, position);
+  }
+
+  size_t first_row =
+      std::lower_bound(result.rows.begin(), result.rows.end(), position,
+                       [](const Row &row, size_t offset) {
+                         return row.offset < offset;
+                       }) -
+      result.rows.begin();
+  size_t nr_of_checksum_errors =
+      result.checksum_errors.end() -
+      std::lower_bound(result.checksum_errors.begin(),
+                       result.checksum_errors.end(), position);
+
+  writer.write_rows(chunk.capture, fixup, 0);
+  writer.write_rows(chunk.capture, result, first_row);
+
+  totals.nr_of_messages += fixup.frames.size() + (result.frames.end() - frame);
+  totals.nr_of_checksum_errors +=
+      fixup.checksum_errors.size() + nr_of_checksum_errors;
+  totals.nr_of_rows += fixup.rows.size() + result.rows.size() - first_row;
+
+  covered = std::max(position, chunk.end);
+  if (frame != result.frames.end()) {
+    const FrameSpan &last_frame = result.frames.back();
+    covered = std::max(covered, last_frame.offset + last_frame.size);
+  }
+}
+
+/**
+ * Memory map a capture.
+ */
+Capture map_capture(const char *path) {
+  int fd = open(path, O_RDONLY);
+  struct stat status;
+  if (fd < 0 || fstat(fd, &status) != 0) {
+    fprintf(stderr, "omnik-decode: %s: %s\n", path, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  Capture capture{path, nullptr, (size_t) status.st_size};
+  if (capture.size > 0) {
+    void *data = mmap(nullptr, capture.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      fprintf(stderr, "omnik-decode: %s: %s\n", path, strerror(errno));
+      exit(EXIT_FAILURE);
+    }
+    madvise(data, capture.size, MADV_SEQUENTIAL);
+    capture.data = (const uint8_t *) data;
+  }
+  close(fd);
+  return capture;
+}
+
+/**
+ * Parse a size with an optional k, M or G suffix.
+ */
+size_t parse_size(const char *text) {
+  char *suffix;
+  unsigned long long size = strtoull(text, &suffix, 10);
+  switch (*suffix) {
+  case 'G':
+    size <<= 10;
+    // fall through
+  case 'M':
+    size <<= 10;
+    // fall through
+  case 'k':
+    size <<= 10;
+    break;
+  }
+  return size;
+}
+
+/**
+ * Get the number of seconds since a point in time.
+ */
+double get_seconds(std::chrono::steady_clock::time_point start_time) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start_time)
+      .count();
+}
+
+/**
+ * Scan a capture as a whole.
+ *
+ * @return The positions of the correct messages (even) and the messages with
+ *         a checksum error (odd), times 2.
+ */
+std::vector<size_t> scan_capture(const Capture &capture) {
+  std::vector<size_t> positions;
+  scan_frames(capture.data, capture.size, 0, capture.size,
+              [&positions](size_t offset, const Frame &, FrameStatus status) {
+                positions.push_back(2 * offset +
+                                    (status == FRAME_CHECKSUM_ERROR));
+              });
+  return positions;
+}
+
+/**
+ * Benchmark the implementations of finding the start bytes and calculating
+ * the checksum and verify that they give the same results as the scalar
+ * implementation.
+ *
+ * @return True in case all the results are the same.
+ */
+bool benchmark(const std::vector<Capture> &captures) {
+  ScanKernel default_kernel = get_scan_kernel();
+  bool is_same = true;
+  for (const Capture &capture : captures) {
+    set_scan_kernel(SCAN_KERNEL_SCALAR);
+    std::vector<size_t> expected_positions = scan_capture(capture);
+    // The checksum of all the lengths of a message, at all alignments.
+    std::vector<uint16_t> expected_checksums;
+    size_t nr_of_lengths = std::min(capture.size, MAX_FRAME_SIZE + 1);
+    size_t nr_of_alignments = std::min<size_t>(capture.size, 64);
+    for (size_t offset = 0; offset < nr_of_alignments; offset++) {
+      for (size_t length = 0; length + offset < nr_of_lengths; length++)
+        expected_checksums.push_back(
+            calculate_checksum(capture.data + offset, length));
+    }
+
+    fprintf(stderr, "%s: %zu bytes, %zu messages\n", capture.path.c_str(),
+            capture.size, expected_positions.size());
+    for (uint8_t i = 0; i < NR_OF_SCAN_KERNELS; i++) {
+      ScanKernel kernel = (ScanKernel) i;
+      if (!set_scan_kernel(kernel)) {
+        fprintf(stderr, "  %-8s not supported\n", get_scan_kernel_name(kernel));
+        continue;
+      }
+
+      auto start_time = std::chrono::steady_clock::now();
+      std::vector<size_t> positions = scan_capture(capture);
+      double scan_seconds = get_seconds(start_time);
+
+      start_time = std::chrono::steady_clock::now();
+      volatile uint16_t checksum =
+          calculate_checksum(capture.data, capture.size);
+      (void) checksum;
+      double checksum_seconds = get_seconds(start_time);
+
+      std::vector<uint16_t> checksums;
+      for (size_t offset = 0; offset < nr_of_alignments; offset++) {
+        for (size_t length = 0; length + offset < nr_of_lengths; length++) {
+          const uint8_t *data = capture.data + offset;
+          checksums.push_back(calculate_checksum(data, length));
+        }
+      }
+
+      bool is_kernel_same =
+          positions == expected_positions && checksums == expected_checksums;
+      is_same = is_same && is_kernel_same;
+      fprintf(stderr, "  %-8s scan %8.1f MB/s  checksum %8.1f MB/s  %s\n",
+              get_scan_kernel_name(kernel),
+              capture.size / 1e6 / std::max(scan_seconds, 1e-9),
+              capture.size / 1e6 / std::max(checksum_seconds, 1e-9),
+              is_kernel_same ? "same" : "DIFFERENT");
+    }
+  }
+  set_scan_kernel(default_kernel);
+  return is_same;
+}
+
+/**
+ * Benchmark the scaling of the raw values as a float against the scaling as a
+ * double, and verify that they give the same values.
+ *
+ * @return True in case the values are the same, bit for bit, for all raw
+ *         values up to 2^24 and within 1 ULP above.
+ */
+bool benchmark_scaling() {
+  static const double DOUBLE_DIVISORS[] = {1.0, 10.0, 100.0, 1000.0};
+  bool is_same = true;
+
+  fprintf(stderr, "scaling:\n");
+  for (uint8_t i = 0; i < NR_OF_REALTIME_FIELDS; i++) {
+    RealtimeField field = (RealtimeField) i;
+    double divisor = DOUBLE_DIVISORS[get_realtime_field_decimals(field)];
+    int32_t min_value = is_signed(field) ? INT16_MIN : 0;
+    int32_t max_value = (1 << 24) - 1;
+
+    // All the raw values that are exactly representable by a float.
+    size_t nr_of_differences = 0;
+    for (int32_t value = min_value; value <= max_value; value++) {
+      float expected = value / divisor;
+      float actual = scale_realtime_field(field, value);
+      nr_of_differences += memcmp(&expected, &actual, sizeof(float)) != 0;
+    }
+
+    // Larger raw values (of the 32 bit fields).
+    uint32_t max_ulps = 0;
+    uint32_t value = 1 << 24;
+    for (uint32_t step = 0; step < (1 << 20) && !is_signed(field); step++) {
+      float expected = (int32_t) value / divisor;
+      float actual = scale_realtime_field(field, value);
+      int32_t expected_bits, actual_bits;
+      memcpy(&expected_bits, &expected, sizeof(float));
+      memcpy(&actual_bits, &actual, sizeof(float));
+      max_ulps = std::max<uint32_t>(max_ulps, abs(expected_bits - actual_bits));
+      value = (value + 0x9E3779B9u * step) & 0x7FFFFFFF;
+    }
+
+    bool is_field_same = nr_of_differences == 0 && max_ulps <= 1;
+    is_same = is_same && is_field_same;
+    if (!is_field_same) {
+      fprintf(stderr, "  %-28s %zu different, %u ULP above 2^24\n",
+              get_realtime_field_name(field), nr_of_differences,
+              (unsigned) max_ulps);
+    }
+  }
+
+  // The time of scaling the raw values of the fields with decimals.
+  std::vector<int32_t> values(1 << 20);
+  for (size_t i = 0; i < values.size(); i++) {
+    values[i] = (int32_t)((i * 2654435761u) % 60000);
+  }
+  const size_t nr_of_rounds = 16;
+  volatile float sum;
+
+  auto start_time = std::chrono::steady_clock::now();
+  float double_sum = 0;
+  for (size_t round = 0; round < nr_of_rounds; round++) {
+    for (size_t i = 0; i < values.size(); i++) {
+      uint8_t decimals = 1 + i % 3;
+      double_sum += values[i] / DOUBLE_DIVISORS[decimals];
+    }
+  }
+  sum = double_sum;
+  double double_seconds = get_seconds(start_time);
+
+  start_time = std::chrono::steady_clock::now();
+  float float_sum = 0;
+  for (size_t round = 0; round < nr_of_rounds; round++) {
+    for (size_t i = 0; i < values.size(); i++) {
+      RealtimeField field = (RealtimeField)(REALTIME_FIELD_R_POWER - i % 2);
+      float_sum += scale_realtime_field(field, values[i]);
+    }
+  }
+  sum = float_sum;
+  (void) sum;
+  double float_seconds = get_seconds(start_time);
+
+  double nr_of_values = (double) nr_of_rounds * values.size();
+  fprintf(stderr, "  double   %6.2f ns/value\n",
+          double_seconds * 1e9 / nr_of_values);
+  fprintf(stderr, "  float    %6.2f ns/value  %s\n",
+          float_seconds * 1e9 / nr_of_values,
+          is_same ? "same" : "DIFFERENT");
+  return is_same;
+}
+
+/**
+ * The heap allocations of the messages with the same ID.
+ */
+struct MessageAllocations {
+  // The number of messages (without the first one).
+  uint64_t nr_of_messages;
+  // The number of allocations.
+  uint64_t nr_of_allocations;
+  // The number of allocated bytes.
+  uint64_t nr_of_bytes;
+  // True in case the first message has been seen.
+  bool is_warm;
+};
+
+/**
+ * The state of a text sensor, like text_sensor::TextSensor keeps it. It is
+ * the text state of the shared message handlers, which publish it like
+ * omnik_base::ChangedTextState does: only in case it has changed.
+ */
+struct TextState {
+  // The last published state.
+  std::string state;
+  // True in case a state has been published.
+  bool has_state;
+
+  void publish(const char *new_state) {
+    if (this->has_state && this->state == new_state)
+      return;
+    this->state = new_state;
+    this->has_state = true;
+  }
+};
+
+/**
+ * The states of the logger that are kept between the messages, like
+ * omnik_logger keeps them in its text sensors.
+ */
+struct LoggerStates {
+  // The text sensors of the 0x10/0x01, 0x12/0x40 and 0x12/0x41 messages.
+  TextState connection_number;
+  TextState serial_device_number;
+  TextState ip_address;
+  // The serial number of the inverter of the 0x10/0x01 message.
+  char inverter_serial_number[omnik_logger::SERIAL_NUMBER_SIZE + 1];
+};
+
+/**
+ * The states of the inverter that are kept between the messages, like
+ * omnik_inverter keeps them in its text sensors and members.
+ */
+struct InverterStates {
+  // The text sensors of the 0x10/0x80, 0x10/0x81, 0x10/0x84, 0x12/0xC0 and
+  // 0x12/0xC1 messages.
+  TextState serial_device_number;
+  TextState status_10_81;
+  TextState status_10_84;
+  TextState status_12_c0;
+  TextState status_12_c1;
+  // The text sensors of the 0x11/0x83 message, which also publishes the
+  // serial number and the firmware versions.
+  TextState nr_of_phases;
+  TextState rated_power;
+  TextState country;
+  TextState firmware_version_main;
+  TextState firmware_version_slave;
+  TextState inverter_model;
+  TextState brand;
+  TextState info_undecoded_text;
+  // The text sensors of the 0x11/0x83 message, as they are passed to the
+  // handler.
+  InverterInfoTextStates<TextState &> info_text_states{
+      nr_of_phases,           rated_power,    country,
+      firmware_version_main,  firmware_version_slave,
+      inverter_model,         brand,          serial_device_number,
+      info_undecoded_text};
+  // The decoded 0x11/0x83 message.
+  InverterInfo info;
+  uint8_t info_undecoded[INFO_UNDECODED_SIZE];
+};
+
+/**
+ * The states that are kept between the messages. The logger and the inverter
+ * are separate components, so they each have their own states.
+ */
+struct MessageStates {
+  LoggerStates logger;
+  InverterStates inverter;
+};
+
+/**
+ * Process a complete message with the same handler code as the firmware,
+ * without ESPHome: the message is dispatched on its ID and data size like the
+ * MESSAGE_HANDLERS of the components, and the handlers decode the data
+ * straight from the frame bytes and publish the text states in case they have
+ * changed. Only the publish_state() of ESPHome is left out.
+ *
+ * @return True in case the message is processed, false in case the firmware
+ *         has no handler for it.
+ */
+bool process_message(const Frame &frame, MessageStates &states,
+                     volatile float &sink) {
+  BigEndianReader reader(frame.data, frame.data_size);
+  LoggerStates &logger = states.logger;
+  InverterStates &inverter = states.inverter;
+
+  switch ((frame.control_code << 8) + frame.function_code) {
+  case 0x1001:
+    if (frame.data_size != omnik_logger::MESSAGE_10_01_SIZE)
+      return false;
+    omnik_logger::process_message_10_01(reader, logger.inverter_serial_number,
+                                        logger.connection_number);
+    return true;
+  case 0x1240:
+    if (frame.data_size != omnik_logger::SERIAL_NUMBER_SIZE)
+      return false;
+    process_string_message<omnik_logger::SERIAL_NUMBER_SIZE>(
+        reader, logger.serial_device_number);
+    return true;
+  case 0x1241:
+    if (frame.data_size != omnik_logger::IP_ADDRESS_SIZE)
+      return false;
+    process_string_message<omnik_logger::IP_ADDRESS_SIZE>(
+        reader, logger.ip_address);
+    return true;
+  case 0x1080:
+    if (frame.data_size != SERIAL_NUMBER_SIZE)
+      return false;
+    process_string_message<SERIAL_NUMBER_SIZE>(reader,
+                                               inverter.serial_device_number);
+    return true;
+  case 0x1081:
+  case 0x1084:
+  case 0x12C0:
+  case 0x12C1: {
+    if (frame.data_size != 1)
+      return false;
+    TextState &text_state =
+        frame.function_code == 0x81   ? inverter.status_10_81
+        : frame.function_code == 0x84 ? inverter.status_10_84
+        : frame.function_code == 0xC0 ? inverter.status_12_c0
+                                      : inverter.status_12_c1;
+    process_status_message(reader, text_state);
+    return true;
+  }
+  case 0x1183:
+    if (frame.data_size != INVERTER_INFO_SIZE)
+      return false;
+    process_inverter_info(reader, inverter.info, inverter.info_undecoded,
+                          inverter.info_text_states);
+    return true;
+  case 0x11C3:
+    if (frame.data_size != 1)
+      return false;
+    sink = sink + reader.get_uint8();
+    return true;
+  case 0x1190: {
+    const MessageLayout *layout = find_message_layout(
+        frame.control_code, frame.function_code, frame.data_size);
+    if (layout == nullptr)
+      return false;
+    RealtimeData data;
+    decode_realtime_data(reader, data);
+    float sum = 0;
+    for (uint8_t i = 0; i < NR_OF_REALTIME_FIELDS; i++) {
+      RealtimeField field = (RealtimeField) i;
+      sum += scale_realtime_field(field, get_realtime_field(data, field));
+    }
+    sink = sink + sum;
+    process_firmware_versions(reader, *layout, inverter.firmware_version_main,
+                              inverter.firmware_version_slave);
+    return true;
+  }
+  default:
+    return false;
+  }
+}
+
+/**
+ * Receive the captures byte by byte and count the heap allocations per
+ * message ID. Only the messages that have a handler in the firmware are
+ * processed and reported.
+ *
+ * @param budget The maximum number of allocations per message in the steady
+ *               state.
+ * @return True in case no message ID exceeds the budget.
+ */
+bool check_allocations(const std::vector<Capture> &captures, double budget) {
+  // Allocated before the counting starts.
+  std::vector<MessageAllocations> allocations(1 << 16);
+  std::unique_ptr<MessageStates> states(new MessageStates());
+  volatile float sink = 0;
+
+  for (const Capture &capture : captures) {
+    FrameAssembler frame_assembler;
+    uint64_t start_allocations = nr_of_allocations;
+    uint64_t start_bytes = nr_of_allocated_bytes;
+    for (size_t i = 0; i < capture.size; i++) {
+      FrameStatus status = frame_assembler.add_byte(capture.data[i], 0);
+      if (status != FRAME_OK)
+        continue;
+      const Frame &frame = frame_assembler.get_frame();
+      if (!process_message(frame, *states, sink)) {
+        // Only the messages that are processed are counted.
+        start_allocations = nr_of_allocations;
+        start_bytes = nr_of_allocated_bytes;
+        continue;
+      }
+
+      // The allocations of receiving and processing the message.
+      uint64_t end_allocations = nr_of_allocations;
+      uint64_t end_bytes = nr_of_allocated_bytes;
+      MessageAllocations &message_allocations =
+          allocations[(frame.control_code << 8) + frame.function_code];
+      if (message_allocations.is_warm) {
+        message_allocations.nr_of_messages++;
+        message_allocations.nr_of_allocations +=
+            end_allocations - start_allocations;
+        message_allocations.nr_of_bytes += end_bytes - start_bytes;
+      }
+      message_allocations.is_warm = true;
+      start_allocations = nr_of_allocations;
+      start_bytes = nr_of_allocated_bytes;
+    }
+  }
+
+  bool is_within_budget = true;
+  bool is_processed = false;
+  fprintf(stderr, "allocations per message (budget %g):\n", budget);
+  for (size_t id = 0; id < allocations.size(); id++) {
+    const MessageAllocations &message_allocations = allocations[id];
+    if (message_allocations.nr_of_messages == 0)
+      continue;
+    double nr_of_messages = message_allocations.nr_of_messages;
+    double per_message = message_allocations.nr_of_allocations / nr_of_messages;
+    bool is_ok = per_message <= budget;
+    is_within_budget = is_within_budget && is_ok;
+    is_processed = true;
+    fprintf(stderr, "  0x%02X/0x%02X %10llu messages %8.2f allocations "
+            "%10.1f bytes  %s\n",
+            (unsigned) (id >> 8), (unsigned) (id & 0xFF),
+            (unsigned long long) message_allocations.nr_of_messages,
+            per_message, message_allocations.nr_of_bytes / nr_of_messages,
+            is_ok ? "ok" : "OVER BUDGET");
+  }
+  if (!is_processed)
+    fprintf(stderr, "  no messages processed\n");
+  return is_within_budget && is_processed;
+}
+
+/**
+ * Show the usage and exit.
+ */
+void usage() {
+  fprintf(stderr,
+          "Usage: omnik-decode [-j threads] [-c chunk size] [-f csv|bin] "
+          "[-k kernel] [-o output] capture...\n"
+          "       omnik-decode -b capture...\n"
+          "       omnik-decode -a budget capture...\n");
+  exit(EXIT_FAILURE);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  unsigned nr_of_threads = std::max(1u, std::thread::hardware_concurrency());
+  size_t chunk_size = DEFAULT_CHUNK_SIZE;
+  bool binary = false;
+  const char *output_path = nullptr;
+  bool is_benchmark = false;
+  double allocation_budget = -1;
+
+  int option;
+  while ((option = getopt(argc, argv, "a:bj:c:f:k:o:")) != -1) {
+    switch (option) {
+    case 'j':
+      nr_of_threads = std::max(1, atoi(optarg));
+      break;
+    case 'c':
+      chunk_size = std::max<size_t>(1, parse_size(optarg));
+      break;
+    case 'f':
+      if (strcmp(optarg, "csv") == 0)
+        binary = false;
+      else if (strcmp(optarg, "bin") == 0)
+        binary = true;
+      else
+        usage();
+      break;
+    case 'k': {
+      uint8_t kernel = 0;
+      while (kernel < NR_OF_SCAN_KERNELS &&
+             strcmp(optarg, get_scan_kernel_name((ScanKernel) kernel)) != 0)
+        kernel++;
+      if (kernel == NR_OF_SCAN_KERNELS || !set_scan_kernel((ScanKernel) kernel))
+        usage();
+      break;
+    }
+    case 'o':
+      output_path = optarg;
+      break;
+    case 'b':
+      is_benchmark = true;
+      break;
+    case 'a':
+      allocation_budget = atof(optarg);
+      if (allocation_budget < 0)
+        usage();
+      break;
+    default:
+      usage();
+    }
+  }
+  if (optind == argc)
+    usage();
+
+  if (is_benchmark) {
+    std::vector<Capture> captures;
+    for (int i = optind; i < argc; i++) {
+      captures.push_back(map_capture(argv[i]));
+    }
+    bool is_same = benchmark(captures);
+    is_same = benchmark_scaling() && is_same;
+    return is_same ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  if (allocation_budget >= 0) {
+    std::vector<Capture> captures;
+    for (int i = optind; i < argc; i++) {
+      captures.push_back(map_capture(argv[i]));
+    }
+    return check_allocations(captures, allocation_budget) ? EXIT_SUCCESS
+                                                          : EXIT_FAILURE;
+  }
+
+  FILE *output = stdout;
+  if (output_path != nullptr && strcmp(output_path, "-") != 0) {
+    output = fopen(output_path, "wb");
+    if (output == nullptr) {
+      perror(output_path);
+      return EXIT_FAILURE;
+    }
+  }
+  static char output_buffer[OUTPUT_BUFFER_SIZE];
+  setvbuf(output, output_buffer, _IOFBF, sizeof(output_buffer));
+  std::unique_ptr<OutputWriter> writer;
+  if (binary)
+    writer.reset(new BinaryWriter(output));
+  else
+    writer.reset(new CsvWriter(output));
+
+  // Split the captures into chunks.
+  std::vector<Capture> captures;
+  std::vector<Chunk> chunks;
+  for (int i = optind; i < argc; i++) {
+    captures.push_back(map_capture(argv[i]));
+    const Capture &capture = captures.back();
+    for (size_t begin = 0; begin < capture.size; begin += chunk_size) {
+      size_t end = std::min(capture.size, begin + chunk_size);
+      uint32_t index = captures.size() - 1;
+      chunks.push_back({index, begin, end, false, {}});
+    }
+  }
+  writer->write_header(captures);
+
+  // Scan the chunks in parallel, but not too far ahead of the writer.
+  auto start_time = std::chrono::steady_clock::now();
+  size_t max_nr_of_pending_chunks = 2 * nr_of_threads;
+  std::atomic<size_t> next_chunk{0};
+  std::mutex mutex;
+  std::condition_variable condition;
+  size_t nr_of_written_chunks = 0;
+  bool is_csv = writer->is_csv();
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < nr_of_threads; i++) {
+    threads.emplace_back([&]() {
+      for (;;) {
+        size_t index = next_chunk++;
+        if (index >= chunks.size())
+          return;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          condition.wait(lock, [&]() {
+            return index < nr_of_written_chunks + max_nr_of_pending_chunks;
+          });
+        }
+        Chunk &chunk = chunks[index];
+        scan_chunk(captures[chunk.capture], is_csv, chunk);
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          chunk.done = true;
+        }
+        condition.notify_all();
+      }
+    });
+  }
+
+  // Write the chunks in order.
+  Totals totals;
+  size_t covered = 0;
+  for (size_t index = 0; index < chunks.size(); index++) {
+    Chunk &chunk = chunks[index];
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait(lock, [&]() { return chunk.done; });
+    }
+    if (chunk.begin == 0)
+      covered = 0;
+    write_chunk(captures[chunk.capture], chunk, covered, *writer, totals);
+    totals.nr_of_bytes += chunk.end - chunk.begin;
+    chunk.result = ScanResult();
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      nr_of_written_chunks++;
+    }
+    condition.notify_all();
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  writer->write_end();
+  if (fflush(output) != 0 || (output != stdout && fclose(output) != 0)) {
+    perror("omnik-decode: write");
+    return EXIT_FAILURE;
+  }
+
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start_time)
+                       .count();
+  fprintf(stderr,
+          "omnik-decode: %zu bytes, %zu messages, %zu checksum errors, "
+          "%zu rows in %.3f s (%.1f MB/s)\n",
+          totals.nr_of_bytes, totals.nr_of_messages,
+          totals.nr_of_checksum_errors, totals.nr_of_rows, seconds,
+          totals.nr_of_bytes / 1e6 / std::max(seconds, 1e-9));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""
+Test the framing of the firmware of the host platform (host-omnik.yaml) at the
+baud rate of the omnik_host_uart of the inverter.
+
+* Length: messages that are sent back to back, without any gap, are all
+  received, because a message ends after the number of bytes in its header.
+* Gap: the bytes of an incomplete message are discarded after the frame gap,
+  so that the next message is received.
+
+The messages are counted with the sequence number of the 0x11/0x90 messages
+in the omnik_server:
+
+    tools/omnik_frame_gap_test.py program baud_rate
+"""
+
+import random
+import sys
+import time
+
+import omnik_capture
+import omnik_host
+
+# The id of the inverter in host-omnik.yaml.
+INVERTER = "Inverter"
+# The number of messages that are sent back to back.
+NR_OF_MESSAGES = 20
+# The number of bits per byte (start bit, 8 data bits and stop bit).
+BITS_PER_BYTE = 10
+# The time of the frame gap in half bytes (FRAME_GAP_HALF_BYTES of
+# omnik_base.cpp) and the minimal frame gap (in seconds). The host UART
+# doesn't hold the received bytes (UART_HOLD_BYTES is 0).
+FRAME_GAP_HALF_BYTES = 7
+MIN_FRAME_GAP = 0.00175
+# The margin for the latency of the loop and the TCP connection (in seconds).
+MARGIN = 0.2
+
+
+def realtime_message(rng):
+    """Return a 0x11/0x90 message."""
+    return omnik_capture.frame(
+        omnik_capture.INVERTER_ADDRESS, omnik_capture.LOGGER_ADDRESS,
+        0x11, 0x90, omnik_capture.realtime_data(rng, False))
+
+
+def get_sequence_number():
+    """Get the sequence number of the last 0x11/0x90 message."""
+    values = omnik_host.read_server()
+    return values.get(INVERTER, {}).get("realtime", {}).get("seq", 0)
+
+
+def wait_for_sequence_number(expected, timeout):
+    """Wait until the expected number of 0x11/0x90 messages is received."""
+    deadline = time.monotonic() + timeout
+    while True:
+        sequence_number = get_sequence_number()
+        if sequence_number >= expected or time.monotonic() > deadline:
+            return sequence_number
+        time.sleep(0.05)
+
+
+def main():
+    program = sys.argv[1]
+    baud_rate = int(sys.argv[2])
+    byte_time = BITS_PER_BYTE / baud_rate
+    frame_gap = max(byte_time * FRAME_GAP_HALF_BYTES / 2, MIN_FRAME_GAP)
+    rng = random.Random(baud_rate)
+    is_ok = True
+
+    with omnik_host.HostProgram(program) as host:
+        # Length: the messages back to back.
+        messages = b"".join(realtime_message(rng)
+                            for _ in range(NR_OF_MESSAGES))
+        start = get_sequence_number()
+        host.feed(messages)
+        received = wait_for_sequence_number(
+            start + NR_OF_MESSAGES, len(messages) * byte_time + MARGIN) - start
+        print("%u baud, length: %u of %u messages" %
+              (baud_rate, received, NR_OF_MESSAGES))
+        is_ok = is_ok and received == NR_OF_MESSAGES
+
+        # Gap: half a message, a pause of more than the frame gap, and a
+        # complete message. Without the gap the complete message would be
+        # taken as the rest of the incomplete one.
+        message = realtime_message(rng)
+        start = get_sequence_number()
+        host.feed(message[:len(message) // 2])
+        time.sleep(len(message) * byte_time + 10 * frame_gap + MARGIN)
+        host.feed(message)
+        received = wait_for_sequence_number(
+            start + 1, len(message) * byte_time + MARGIN) - start
+        print("%u baud, gap of %.2f ms: %u of 1 message" %
+              (baud_rate, frame_gap * 1000, received))
+        is_ok = is_ok and received == 1
+
+    print("ok" if is_ok else "FAILED")
+    sys.exit(0 if is_ok else 1)
+
+
+if __name__ == "__main__":
+    main()
+
+# vim:sw=4:
@@ -0,0 +1,87 @@
+"""
+Run the firmware of the host platform (host-omnik.yaml) for the host tests.
+
+The program is fed through the TCP port of an omnik_host_uart, and its state
+is read from the TCP port of the omnik_server.
+"""
+
+import json
+import socket
+import subprocess
+import time
+
+# The TCP port of the omnik_host_uart of the inverter.
+UART_PORT = 8898
+# The TCP port of the omnik_server.
+SERVER_PORT = 8899
+# The time to wait for the program to start (in seconds).
+START_TIMEOUT = 30
+
+
+class HostProgram:
+    """The firmware as a Linux process."""
+
+    def __init__(self, program):
+        self.process = subprocess.Popen(
+            [program], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        self.uart = None
+
+    def __enter__(self):
+        wait_for_port(SERVER_PORT, START_TIMEOUT)
+        wait_for_port(UART_PORT, START_TIMEOUT)
+        return self
+
+    def __exit__(self, *exception):
+        if self.uart is not None:
+            self.uart.close()
+        self.process.terminate()
+        self.process.wait()
+
+    def feed(self, data):
+        """Send bytes to the omnik_host_uart of the inverter."""
+        if self.uart is None:
+            self.uart = socket.create_connection(("localhost", UART_PORT))
+        self.uart.sendall(data)
+
+
+def wait_for_port(port, timeout):
+    """Wait until a TCP port on the local host accepts a connection."""
+    deadline = time.monotonic() + timeout
+    while True:
+        try:
+            # The omnik_host_uart only serves one client, so the probe of
+            # its port is closed at once.
+            socket.create_connection(("localhost", port), 1).close()
+            return
+        except OSError:
+            if time.monotonic() > deadline:
+                raise
+            time.sleep(0.1)
+
+
+def read_server(port=SERVER_PORT):
+    """Read the line of the omnik_server and check that it is JSON."""
+    with socket.create_connection(("localhost", port), 10) as connection:
+        text = b""
+        while True:
+            data = connection.recv(4096)
+            if not data:
+                break
+            text += data
+    if not text.endswith(b"\n") or text.count(b"\n") != 1:
+        raise ValueError("not one line: %r" % text)
+    return json.loads(text)
+
+
+def wait_for_server(predicate, timeout):
+    """Read the omnik_server until the predicate holds for the values."""
+    deadline = time.monotonic() + timeout
+    while True:
+        values = read_server()
+        if predicate(values):
+            return values
+        if time.monotonic() > deadline:
+            raise TimeoutError("unexpected values: %s" % values)
+        time.sleep(0.5)
+
+# vim:sw=4:
@@ -0,0 +1,177 @@
+/**
+ * Check the output of the LineWriter of omnik_http.
+ *
+ * The responses of omnik_http are rendered line by line while they are sent,
+ * with next_line() or with fill() in chunks of the size that the web server
+ * asks for. The check renders a set of lines (including a line that is too
+ * long) with next_line() and with fill() for every chunk size up to a few
+ * lines, and verifies that the output is always the same and has the expected
+ * text. It also verifies the formatting of the raw values with decimals.
+ *
+ * Usage: omnik-line-writer-check
+ */
+#include "omnik_http/omnik_line_writer.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using esphome::omnik_http::LineWriter;
+
+namespace {
+
+// The length of the text of the line that is too long.
+static const size_t LONG_LINE_LENGTH = 600;
+// The largest chunk size that is checked.
+static const size_t MAX_CHUNK_SIZE = 2048;
+
+/**
+ * A raw value with a number of decimals and the expected text.
+ */
+struct ValueCase {
+  // The raw value.
+  int64_t value;
+  // The number of decimals.
+  uint8_t decimals;
+  // The expected text.
+  const char *text;
+};
+
+// The values of which the formatting is checked.
+static const ValueCase VALUE_CASES[] = {
+    {0, 0, "0"},
+    {7, 0, "7"},
+    {-7, 0, "-7"},
+    {12345, 2, "123.45"},
+    {100, 1, "10.0"},
+    {5, 2, "0.05"},
+    {-5, 2, "-0.05"},
+    {-12345, 3, "-12.345"},
+    {123456, 1, "12345.6"},
+    {INT64_MAX, 0, "9223372036854775807"},
+    {-INT64_MAX, 4, "-922337203685477.5807"},
+};
+// The number of values.
+static const size_t NR_OF_VALUE_CASES =
+    sizeof(VALUE_CASES) / sizeof(VALUE_CASES[0]);
+
+/**
+ * The writer that renders one line per value, a line that is too long and a
+ * last short line.
+ */
+class CheckWriter : public LineWriter {
+public:
+  /**
+   * Get the text that the writer has to render.
+   */
+  static std::string get_expected_text() {
+    std::string text;
+    for (const ValueCase &value_case : VALUE_CASES) {
+      text += std::string("value ") + value_case.text + "\n";
+    }
+    // The long line is truncated to the size of the line buffer and ends with
+    // a new line.
+    std::string long_line(LONG_LINE_LENGTH, 'x');
+    text += long_line.substr(0, sizeof(line_) - 2) + "\n";
+    text += "end\n";
+    return text;
+  }
+
+protected:
+  /**
+   * @see LineWriter.
+   */
+  int render_line() override {
+    int length = 0;
+    if (this->index_ < NR_OF_VALUE_CASES) {
+      const ValueCase &value_case = VALUE_CASES[this->index_];
+      append(length, "value ");
+      append_value(length, value_case.value, value_case.decimals);
+      append(length, "\n");
+    } else if (this->index_ == NR_OF_VALUE_CASES) {
+      append(length, "%s\n", std::string(LONG_LINE_LENGTH, 'x').c_str());
+    } else if (this->index_ == NR_OF_VALUE_CASES + 1) {
+      append(length, "end\n");
+    } else {
+      return -1;
+    }
+    this->index_++;
+    return length;
+  }
+
+private:
+  // The index of the next line.
+  size_t index_{0};
+};
+
+/**
+ * Render the response with next_line().
+ */
+std::string render_lines() {
+  CheckWriter writer;
+  std::string text;
+  const char *line;
+  while ((line = writer.next_line()) != nullptr) {
+    text += line;
+  }
+  return text;
+}
+
+/**
+ * Render the response with fill() in chunks of a size.
+ *
+ * @param chunk_size The size of the chunks.
+ * @param is_ok Set to false in case a chunk is too large.
+ */
+std::string render_chunks(size_t chunk_size, bool &is_ok) {
+  CheckWriter writer;
+  std::vector<uint8_t> buffer(chunk_size);
+  std::string text;
+  size_t length;
+  while ((length = writer.fill(buffer.data(), chunk_size)) > 0) {
+    if (length > chunk_size) {
+      is_ok = false;
+      break;
+    }
+    text.append(reinterpret_cast<const char *>(buffer.data()), length);
+  }
+  // The end of the response stays the end.
+  if (writer.fill(buffer.data(), chunk_size) != 0) {
+    is_ok = false;
+  }
+  return text;
+}
+
+} // namespace
+
+int main() {
+  const std::string expected = CheckWriter::get_expected_text();
+  bool is_ok = true;
+
+  std::string lines = render_lines();
+  if (lines != expected) {
+    fprintf(stderr, "next_line: unexpected output:\n%s", lines.c_str());
+    is_ok = false;
+  }
+
+  size_t nr_of_failed_chunk_sizes = 0;
+  for (size_t chunk_size = 1; chunk_size <= MAX_CHUNK_SIZE; chunk_size++) {
+    bool is_chunk_ok = true;
+    if (render_chunks(chunk_size, is_chunk_ok) != expected || !is_chunk_ok) {
+      if (nr_of_failed_chunk_sizes == 0) {
+        fprintf(stderr, "fill: unexpected output with chunks of %zu bytes\n",
+                chunk_size);
+      }
+      nr_of_failed_chunk_sizes++;
+      is_ok = false;
+    }
+  }
+
+  printf("%zu lines, %zu bytes, chunk sizes 1-%zu: %zu failed\n",
+         NR_OF_VALUE_CASES + 2, expected.size(), MAX_CHUNK_SIZE,
+         nr_of_failed_chunk_sizes);
+  printf("%s\n", is_ok ? "ok" : "FAILED");
+  return is_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""
+Test the omnik_server of the firmware of the host platform (host-omnik.yaml).
+
+The capture is fed to the inverter, and then several clients connect to the
+omnik_server at the same time. Each client has to receive one line with the
+JSON object of the inverter, with the realtime values and the info:
+
+    tools/omnik_server_test.py program capture [nr of clients]
+"""
+
+import json
+import socket
+import sys
+import threading
+
+import omnik_host
+
+# The id of the inverter in host-omnik.yaml.
+INVERTER = "Inverter"
+# The serial number of the inverter in the capture (tools/omnik_capture.py).
+SERIAL_NUMBER = "NLDN202015123456"
+# The time to wait for the messages of the capture (in seconds).
+MESSAGE_TIMEOUT = 60
+
+
+def has_messages(values):
+    """Check whether the 0x11/0x90 and 0x11/0x83 messages are received."""
+    inverter = values.get(INVERTER, {})
+    return "realtime" in inverter and "info" in inverter
+
+
+def check_values(values):
+    """Check the JSON object of the omnik_server."""
+    realtime = values[INVERTER]["realtime"]
+    info = values[INVERTER]["info"]
+    assert isinstance(realtime["seq"], int), realtime
+    for name, value in realtime.items():
+        assert isinstance(value, (int, float)), (name, value)
+    assert isinstance(realtime["run_state"], int), realtime
+    assert info["serial_number"] == SERIAL_NUMBER, info
+
+
+def read_client(barrier, results, index):
+    """Connect at the same time as the other clients and read the line."""
+    try:
+        barrier.wait()
+        results[index] = omnik_host.read_server()
+    except (OSError, ValueError) as exception:
+        results[index] = exception
+
+
+def main():
+    program = sys.argv[1]
+    with open(sys.argv[2], "rb") as file:
+        capture = file.read()
+    nr_of_clients = int(sys.argv[3]) if len(sys.argv) > 3 else 8
+
+    with omnik_host.HostProgram(program) as host:
+        host.feed(capture)
+        omnik_host.wait_for_server(has_messages, MESSAGE_TIMEOUT)
+
+        # A client that doesn't read must not hold up the others.
+        idle_client = socket.create_connection(
+            ("localhost", omnik_host.SERVER_PORT))
+        barrier = threading.Barrier(nr_of_clients)
+        results = [None] * nr_of_clients
+        threads = [threading.Thread(target=read_client,
+                                    args=(barrier, results, index))
+                   for index in range(nr_of_clients)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        idle_client.close()
+
+    is_ok = True
+    for index, result in enumerate(results):
+        try:
+            if isinstance(result, Exception):
+                raise result
+            check_values(result)
+            print("client %d: ok (seq %d)" %
+                  (index, result[INVERTER]["realtime"]["seq"]))
+        except (AssertionError, KeyError, OSError, ValueError) as exception:
+            print("client %d: FAILED %r" % (index, exception))
+            is_ok = False
+    print(json.dumps(results[0]) if is_ok else "FAILED")
+    sys.exit(0 if is_ok else 1)
+
+
+if __name__ == "__main__":
+    main()
+
+# vim:sw=4: